@@ -4,6 +4,13 @@
 
 #include "Sandbox.hpp"
 #include <filesystem>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Pans towards the cursor, up to a quarter of the screen at its edges
+static glm::mat4 makeCamera(const glm::vec2 &cursorPosition, const glm::vec2 &screenSize) {
+    glm::vec2 offset = (cursorPosition / screenSize * 2.0f - 1.0f) * 0.25f;
+    return glm::translate(glm::mat4(1.0f), glm::vec3(-offset, 0.0f));
+}
 
 void Sandbox::start() {
     GlobalSettings settings;
@@ -33,3 +40,12 @@ void Sandbox::update(double deltaTime) {
         cursor.update(sglazPath.c_str());
     }
 }
+
+void Sandbox::fillRenderPacket(RenderPacket &packet) {
+    glm::vec2 screenSize = glm::max(glm::vec2(Events::getFramebufferSize()), glm::vec2(1.0f));
+    packet.viewProjection = makeCamera(Events::getCursorPos(), screenSize);
+    // Runs on the render thread, so only the screen size is captured
+    packet.latchViewProjection = [screenSize](const glm::vec2 &cursorPosition) {
+        return makeCamera(cursorPosition, screenSize);
+    };
+}
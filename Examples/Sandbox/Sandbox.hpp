@@ -6,5 +6,6 @@ class Sandbox : public Level {
 public:
     void start() override;
     void update(double deltaTime) override;
+    void fillRenderPacket(RenderPacket &packet) override;
 private:
 };
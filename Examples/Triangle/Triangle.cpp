@@ -4,6 +4,11 @@
 
 #include "Triangle.hpp"
 
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+static constexpr int instanceCount = 16;
+
 void Triangle::start() {
     GlobalSettings settings;
     settings.appName = "Petuh";
@@ -13,5 +18,17 @@ void Triangle::start() {
 }
 
 void Triangle::update(double deltaTime) {
+    angle += static_cast<float>(deltaTime);
+}
 
+void Triangle::fillRenderPacket(RenderPacket &packet) {
+    // A ring of GPU-driven triangles, culled and drawn without a CPU draw call each
+    for (int i = 0; i < instanceCount; ++i) {
+        float offset = angle + glm::two_pi<float>() * static_cast<float>(i) / instanceCount;
+        RenderInstance &instance = packet.instances.emplace_back();
+        glm::vec3 position(glm::cos(offset) * 0.7f, glm::sin(offset) * 0.7f, 0.5f);
+        instance.transform = glm::translate(glm::mat4(1.0f), position);
+        instance.transform = glm::scale(instance.transform, glm::vec3(0.2f));
+        instance.boundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, 0.75f);
+    }
 }
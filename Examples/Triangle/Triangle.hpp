@@ -6,5 +6,7 @@ class Triangle : public Level {
 public:
     void start() override;
     void update(double deltaTime) override;
+    void fillRenderPacket(RenderPacket &packet) override;
 private:
+    float angle = 0.0f;
 };
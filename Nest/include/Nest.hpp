@@ -3,6 +3,7 @@
 #include "Nest/Application/Application.hpp"
 #include "Nest/Window/Window.hpp"
 #include "Nest/Window/Events.hpp"
+#include "Nest/Jobs/JobSystem.hpp"
 
 #include "Nest/Logger/Logger.hpp"
 #include "Nest/Objects/Level.hpp"
@@ -6,6 +6,7 @@
 #include "Nest/Logger/Logger.hpp"
 #include "Nest/Objects/Level.hpp"
 #include "Nest/Renderer/Renderer.hpp"
+#include "Nest/Renderer/RenderThread.hpp"
 #include "Nest/Objects/GlobalSettings.hpp"
 
 class Application final {
@@ -33,12 +34,29 @@ public:
     inline void setLevel(Level* level) {
         currentLevel = level;
     }
+
+    // Counters and timings of the last rendered frame, see FrameStats
+    FrameStats getFrameStats();
+
+    inline GlobalSettings::PresentMode getPresentMode() const {
+        return presentMode;
+    }
+
+    // Applied by the renderer with the next frame
+    inline void setPresentMode(GlobalSettings::PresentMode mode) {
+        presentMode = mode;
+    }
 private:
     Application();
     static Application *s_instance;
     Window* window;
     Level *currentLevel;
-    Renderer *renderer;
+    Renderer *renderer = nullptr;
+    RenderThread renderThread;
+    // Used instead of the render thread packets when rendering on this thread
+    RenderPacket renderPacket;
+    uint64_t frameCount = 0;
+    GlobalSettings::PresentMode presentMode = GlobalSettings::Mailbox;
 
     bool debugMode;
 
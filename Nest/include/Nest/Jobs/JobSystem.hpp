@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+// Pool of worker threads the engine spreads per-frame work over
+class JobSystem final {
+public:
+    // 0 workers means one per spare hardware thread
+    static void init(uint32_t workerCount = 0);
+    static void shutdown();
+
+    // Workers plus the thread that dispatches work, valid thread indices are below this
+    static uint32_t getThreadCount();
+
+    // Runs job(index, threadIndex) for every index below count and returns when all of them finished.
+    // The calling thread helps out, so this also works without workers. Dispatches from several threads run one
+    // after another, jobs must not dispatch themselves.
+    static void parallelFor(uint32_t count, const std::function<void(uint32_t index, uint32_t threadIndex)> &job);
+
+private:
+    static void workerLoop(uint32_t threadIndex);
+
+    static std::vector<std::thread> workers;
+    static std::deque<std::function<void(uint32_t)>> jobs;
+    static std::mutex mutex;
+    // Held for a whole dispatch, the caller thread index is shared by every dispatching thread
+    static std::mutex dispatchMutex;
+    static std::condition_variable wakeUp;
+    static bool running;
+};
@@ -8,9 +8,22 @@ struct GlobalSettings {
         Vulkan
     };
 
+    enum PresentMode {
+        // Waits for vertical blank, never tears
+        Fifo,
+        // Like Fifo, but a late frame is shown right away and may tear
+        FifoRelaxed,
+        // Never tears or blocks, the newest frame replaces a queued one
+        Mailbox,
+        // Shown right away, tears
+        Immediate
+    };
+
     GlobalSettings()
             : appName("GLFW Window"), resolutionX(640), resolutionY(480), fullScreen(false), debugMode(true),
-              api(Vulkan) {}
+              api(Vulkan), framesInFlight(2), workerThreads(0),
+              staticCommandBuffers(true), renderThread(false), renderPackets(2), pipelineStatistics(false),
+              presentMode(Mailbox), presentThrottle(true), lateLatch(true) {}
 
     std::string appName;
     GraphicsAPI api;
@@ -18,4 +31,24 @@ struct GlobalSettings {
     int resolutionY;
     bool fullScreen;
     bool debugMode;
+    // Frames the CPU may record ahead of the GPU (1-3), fewer means lower latency
+    int framesInFlight;
+    // Job system workers, 0 uses every spare hardware thread
+    int workerThreads;
+    // Replay the main pass recording of every swapchain image until the scene or swapchain changes
+    bool staticCommandBuffers;
+    // Render on a dedicated thread fed with render packets, the game thread never waits on the GPU
+    bool renderThread;
+    // Packets between the threads (2-3), each one more lets the game thread run a frame further ahead
+    int renderPackets;
+    // Collect vertex, fragment and compute invocation counts of every render graph pass
+    bool pipelineStatistics;
+    // Falls back to Fifo when the surface doesn't support it, Application::setPresentMode changes it while running
+    PresentMode presentMode;
+    // With VK_KHR_present_wait a frame only starts once the present before the previous one is on screen, so no
+    // more than one finished frame waits for presentation
+    bool presentThrottle;
+    // Let the renderer rebuild the camera from the newest cursor position right before recording, for levels that
+    // set RenderPacket::latchViewProjection
+    bool lateLatch;
 };
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "Nest/Renderer/RenderPacket.hpp"
+
 class Level {
 public:
     virtual void start() = 0;
     virtual void update(double deltaTime) = 0;
+    // Called after update, adds the camera and draws of the frame and optionally a late latch of the camera
+    virtual void fillRenderPacket(RenderPacket &packet) {}
 };
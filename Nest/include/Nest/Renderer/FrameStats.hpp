@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GPU time of a profiler zone, depth counts the zones it is nested in
+struct GpuZoneStats {
+    std::string name;
+    uint32_t depth = 0;
+    float milliseconds = 0.0f;
+};
+
+// Pipeline statistics of a render graph pass
+struct PassStatistics {
+    std::string name;
+    uint64_t inputVertices = 0;
+    uint64_t vertexShaderInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentShaderInvocations = 0;
+    uint64_t computeShaderInvocations = 0;
+};
+
+// What limited a frame: the CPU recording it, the CPU waiting on the GPU or waiting on the presentation engine
+enum class FrameBound {
+    Cpu,
+    Gpu,
+    Present
+};
+
+// Blocking time of a frame and how the recent frames were bound, filled by StallDetector
+struct StallStats {
+    float frameMilliseconds = 0.0f;
+    // Fence and timeline waits
+    float gpuWaitMilliseconds = 0.0f;
+    float acquireMilliseconds = 0.0f;
+    // Present call and present fence waits
+    float presentMilliseconds = 0.0f;
+    FrameBound bound = FrameBound::Cpu;
+    // Over the rolling window
+    uint32_t cpuBoundFrames = 0;
+    uint32_t gpuBoundFrames = 0;
+    uint32_t presentBoundFrames = 0;
+};
+
+// Input to photon latency over the frames that reflected new input, filled by LatencyTracker
+struct LatencyStats {
+    float lastMilliseconds = 0.0f;
+    float p50Milliseconds = 0.0f;
+    float p90Milliseconds = 0.0f;
+    float p99Milliseconds = 0.0f;
+    float maxMilliseconds = 0.0f;
+    // In the rolling window the percentiles are taken over
+    uint32_t samples = 0;
+};
+
+// Counters of the last rendered frame
+struct FrameStats {
+    uint32_t draws = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t descriptorBinds = 0;
+    // Binds skipped because the sorted draw before used the same state
+    uint32_t pipelineBindsSaved = 0;
+    uint32_t descriptorBindsSaved = 0;
+    // Times the dynamic raster state was set, only when a draw's differs from the one before
+    uint32_t rasterStateChanges = 0;
+    // Pipelines created so far, raster state the device sets dynamically doesn't add any
+    uint32_t pipelines = 0;
+    // Pass recordings replayed from the static command cache instead of recorded
+    uint32_t commandBuffersReused = 0;
+    // Queue submit calls and the batches they carried
+    uint32_t submits = 0;
+    uint32_t submitBatches = 0;
+    // GPU timings, these lag behind the counters by the frames in flight
+    std::vector<GpuZoneStats> gpuZones;
+    float gpuFrameMilliseconds = 0.0f;
+    // Empty unless GlobalSettings::pipelineStatistics is set and supported, lags behind like the GPU timings
+    std::vector<PassStatistics> passStatistics;
+    // Of the frame rendered before, as a frame only ends when the next one starts
+    StallStats stalls;
+    LatencyStats inputLatency;
+};
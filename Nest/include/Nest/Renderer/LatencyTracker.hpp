@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "Nest/Renderer/FrameStats.hpp"
+
+// Matches the input time a frame carries with the moment that frame is known to be on screen. Times are seconds of
+// Events::getTime(). The screen time is only as accurate as the renderer can observe it: the return of a present wait,
+// or GPU completion as a lower bound on devices without one.
+class LatencyTracker {
+public:
+    // The frame is the first one to reflect input from inputTime on
+    void submit(uint64_t frame, double inputTime);
+    // Every frame up to and including `frame` was on screen by `time`
+    void displayed(uint64_t frame, double time);
+
+    const LatencyStats &getStats() const;
+
+private:
+    static constexpr uint32_t windowSize = 256;
+
+    struct Pending {
+        uint64_t frame;
+        double inputTime;
+    };
+
+    void updatePercentiles();
+
+    std::deque<Pending> m_pending;
+    // Ring of the latest samples in milliseconds
+    std::vector<float> m_samples;
+    uint32_t m_nextSample = 0;
+    // Reused to take percentiles without touching the ring order
+    std::vector<float> m_sorted;
+    LatencyStats m_stats;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Nest/Objects/GlobalSettings.hpp"
+
+// Fixed function state of a draw. Draws that differ only in state the device sets while recording share a pipeline.
+struct RenderRasterState {
+    enum Topology { Triangles, Lines, Points };
+    enum CullMode { CullNone, CullFront, CullBack };
+
+    Topology topology = Triangles;
+    CullMode cullMode = CullBack;
+    bool depthTest = false;
+    bool depthWrite = false;
+    bool blend = false;
+
+    bool operator==(const RenderRasterState &other) const = default;
+};
+
+// Draw of the default pipeline, the per-draw data ends up in DrawPushConstants
+struct RenderDraw {
+    uint32_t vertexCount = 3;
+    uint32_t instanceCount = 1;
+    uint32_t firstVertex = 0;
+    uint32_t firstInstance = 0;
+    glm::mat4 transform = glm::mat4(1.0f);
+    uint32_t materialIndex = 0;
+    // Slots of the bindless heap
+    uint32_t textureIndex = 0;
+    uint32_t samplerIndex = 0;
+    // Normalized view depth used for sorting
+    float depth = 0.0f;
+    bool translucent = false;
+    RenderRasterState rasterState;
+
+    bool operator==(const RenderDraw &other) const = default;
+};
+
+// Instance of the GPU-driven path, culled and drawn on the GPU without a draw call of its own
+struct RenderInstance {
+    glm::mat4 transform = glm::mat4(1.0f);
+    // Center in model space and radius, used for frustum culling
+    glm::vec4 boundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    // Mesh 0 is the triangle every renderer starts with
+    uint32_t meshIndex = 0;
+    uint32_t materialIndex = 0;
+    uint32_t textureIndex = 0;
+    uint32_t samplerIndex = 0;
+
+    bool operator==(const RenderInstance &other) const = default;
+};
+
+// Everything the renderer needs for one frame, written by the game thread and read by the renderer.
+// Packets are complete snapshots, the renderer keeps no references into them after render() returns.
+struct RenderPacket {
+    uint64_t frame = 0;
+    // Set when the framebuffer size changed since the previous packet
+    bool resized = false;
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+    // A change recreates the swapchain
+    GlobalSettings::PresentMode presentMode = GlobalSettings::Mailbox;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    // Replaces viewProjection with one built from the newest cursor position just before recording. It runs on the
+    // render thread, so it must only use what it captured by value.
+    std::function<glm::mat4(const glm::vec2 &cursorPosition)> latchViewProjection;
+    // Events::getTime() of the oldest input this frame is the first to reflect, 0 if there was none
+    double inputTime = 0.0;
+    std::vector<RenderDraw> draws;
+    // Ignored when the device can't render GPU-driven
+    std::vector<RenderInstance> instances;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Nest/Renderer/Renderer.hpp"
+#include "Nest/Renderer/RenderPacket.hpp"
+
+// Runs the renderer on its own thread. The game thread fills render packets and hands them over in order, the
+// render thread owns every graphics API call, so waiting on fences, acquire or present never stalls simulation.
+// With N packets the game thread can be N - 1 frames ahead of the frame being rendered before it blocks.
+class RenderThread final {
+public:
+    ~RenderThread();
+
+    // The renderer must be initialized, it is only used by the render thread until stop()
+    void start(Renderer *renderer, uint32_t packetCount);
+    // Renders the packets still queued and joins the thread
+    void stop();
+    bool isRunning() const;
+
+    // Packet to fill for the next frame, blocks while every packet is queued or rendering
+    RenderPacket &beginPacket();
+    // Queues the packet returned by beginPacket
+    void submitPacket();
+
+    // Copy of the stats of the last rendered frame, safe to call from the game thread
+    FrameStats getFrameStats();
+
+private:
+    void loop();
+
+    Renderer *m_renderer = nullptr;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_packetQueued;
+    std::condition_variable m_packetReleased;
+    bool m_running = false;
+
+    std::vector<RenderPacket> m_packets;
+    uint32_t m_writeIndex = 0;
+    uint32_t m_readIndex = 0;
+    // Submitted packets including the one being rendered
+    uint32_t m_queuedCount = 0;
+    // Copied after every frame, the renderer's own stats are only valid on the render thread
+    FrameStats m_frameStats;
+};
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "Nest/Objects/GlobalSettings.hpp"
+#include "Nest/Renderer/FrameStats.hpp"
+#include "Nest/Renderer/RenderPacket.hpp"
 
 struct Renderer {
     virtual void init(const GlobalSettings &globalSettings) = 0;
-    virtual void render() = 0;
+    virtual void render(const RenderPacket &packet) = 0;
+    virtual void resize(int width, int height) = 0;
+    // Written by render(), only read it from the thread rendering
+    virtual const FrameStats &getFrameStats() const = 0;
     virtual ~Renderer() = default;
 };
\ No newline at end of file
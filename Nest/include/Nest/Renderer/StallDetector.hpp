@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "Nest/Renderer/FrameStats.hpp"
+
+// Times the points where rendering blocks and classifies every frame by what it spent most of its time on: running
+// on the CPU, waiting for the GPU to finish an earlier frame, or waiting for acquire and present. Keeps counts over
+// a rolling window and warns when one kind of frame takes over the window.
+class StallDetector {
+public:
+    enum class Point {
+        GpuWait,
+        Acquire,
+        Present
+    };
+
+    // Measures the lifetime of the scope as blocked at the point
+    class Scope {
+    public:
+        Scope(StallDetector &detector, Point point);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        StallDetector &m_detector;
+        Point m_point;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    void init(bool debug);
+
+    // Ends the previous frame, which then becomes the one getStats() describes
+    void beginFrame();
+    void addStall(Point point, float milliseconds);
+
+    const StallStats &getStats() const;
+
+private:
+    static constexpr uint32_t windowSize = 120;
+    // Share of the window a bound needs before the warning
+    static constexpr float dominantShare = 0.9f;
+
+    uint32_t &getBoundFrames(FrameBound bound);
+
+    bool m_debug = false;
+    bool m_started = false;
+    std::chrono::steady_clock::time_point m_frameStart;
+    std::array<float, 3> m_current = {};
+
+    std::array<FrameBound, windowSize> m_window = {};
+    uint32_t m_windowFrames = 0;
+    uint32_t m_windowIndex = 0;
+    // Bound last warned about, reset once nothing dominates
+    bool m_warned = false;
+    FrameBound m_warnedBound = FrameBound::Cpu;
+
+    StallStats m_stats;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+
+#include "QueueFamilies.hpp"
+#include "SubmitBatcher.hpp"
+
+using namespace vk;
+
+// Compute work of a frame running on the async compute queue, overlapping with the graphics work of earlier frames.
+// Graphics waits for it through a semaphore at the stages consuming its results. Exclusive resources written by
+// compute are handed over with queue ownership transfers: the release is recorded at the end of the compute work,
+// the acquire into the graphics command buffer by acquire().
+// Without a compute queue the work is submitted to the graphics queue in front of the frame and the transfers turn
+// into ordinary barriers.
+class AsyncCompute {
+public:
+    void init(const Device &device, const QueueFamilyIndices &indices, const Queue &computeQueue,
+              const Queue &graphicsQueue, uint32_t framesInFlight, bool synchronization2,
+              const DispatchLoaderDynamic &dld, bool debug);
+    void destroy();
+
+    // True if the work runs on a queue of its own
+    bool isAsync() const;
+    // Families of both queues, resources shared without ownership transfers are created concurrent over them
+    std::vector<uint32_t> getQueueFamilies() const;
+
+    // Recycles the frame slot, its previous frame has completed
+    void beginFrame(uint32_t frameIndex);
+    // Compute command buffer of the frame, begun on the first call
+    CommandBuffer getCommandBuffer();
+    // Memory dependency between two parts of the compute work
+    void barrier(PipelineStageFlags2 srcStages, AccessFlags2 srcAccess, PipelineStageFlags2 dstStages,
+                 AccessFlags2 dstAccess);
+
+    // Hands a resource written by the compute work over to graphics
+    void transferBuffer(const Buffer &buffer, PipelineStageFlags2 srcStages, AccessFlags2 srcAccess,
+                        PipelineStageFlags2 dstStages, AccessFlags2 dstAccess);
+    void transferImage(const Image &image, const ImageSubresourceRange &range, ImageLayout layout,
+                       PipelineStageFlags2 srcStages, AccessFlags2 srcAccess, PipelineStageFlags2 dstStages,
+                       AccessFlags2 dstAccess);
+
+    // Ends the compute work of the frame and submits it, graphics waits for it at waitStages
+    void submit(SubmitBatcher &batcher, PipelineStageFlags2 waitStages);
+    // Records the acquires of the transferred resources, before graphics uses them
+    void acquire(const CommandBuffer &commandBuffer);
+
+private:
+    struct FrameData {
+        CommandPool pool;
+        CommandBuffer commandBuffer;
+        // Signaled by the compute work, waited by the graphics work of the same frame
+        Semaphore finished;
+    };
+
+    Device m_device;
+    Queue m_computeQueue;
+    Queue m_graphicsQueue;
+    uint32_t m_computeFamily = 0;
+    uint32_t m_graphicsFamily = 0;
+    bool m_async = false;
+    bool m_synchronization2 = false;
+    const DispatchLoaderDynamic *m_dld = nullptr;
+    bool m_debug = false;
+
+    std::vector<FrameData> m_frames;
+    uint32_t m_frameIndex = 0;
+    bool m_recording = false;
+
+    std::vector<BufferMemoryBarrier2> m_bufferReleases;
+    std::vector<ImageMemoryBarrier2> m_imageReleases;
+    std::vector<BufferMemoryBarrier2> m_bufferAcquires;
+    std::vector<ImageMemoryBarrier2> m_imageAcquires;
+};
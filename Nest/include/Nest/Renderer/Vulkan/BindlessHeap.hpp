@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+
+#include "Device.hpp"
+
+using namespace vk;
+
+// Global descriptor set of large partially bound arrays, indexed from shaders (see Bindless.glsl).
+// Resources are written once when they are added, so draws only pass indices and never bind descriptors.
+// The arrays are update-after-bind, adding a resource is allowed while the set is bound by frames in flight.
+class BindlessHeap {
+public:
+    static constexpr uint32_t sampledImageBinding = 0;
+    static constexpr uint32_t samplerBinding = 1;
+    static constexpr uint32_t storageBufferBinding = 2;
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+    void init(const Device &device, const PhysicalDevice &physicalDevice, bool debug);
+    void destroy();
+
+    uint32_t addSampledImage(const ImageView &imageView, ImageLayout layout = ImageLayout::eShaderReadOnlyOptimal);
+    uint32_t addSampler(const Sampler &sampler);
+    uint32_t addStorageBuffer(const Buffer &buffer, DeviceSize offset = 0, DeviceSize range = VK_WHOLE_SIZE);
+
+    // The slot is reused by the next add, so no frame in flight may still read it (see DeletionQueue)
+    void removeSampledImage(uint32_t index);
+    void removeSampler(uint32_t index);
+    void removeStorageBuffer(uint32_t index);
+
+    void bind(const CommandBuffer &commandBuffer, PipelineBindPoint bindPoint, const PipelineLayout &layout,
+              uint32_t setIndex = 0) const;
+
+    DescriptorSetLayout getLayout() const;
+
+private:
+    // Slots of one binding, freed indices are reused before the array grows
+    struct Slots {
+        uint32_t capacity = 0;
+        uint32_t next = 0;
+        std::vector<uint32_t> freed;
+
+        uint32_t allocate();
+        void release(uint32_t index);
+    };
+
+    Device m_device;
+    bool m_debug = false;
+    DescriptorSetLayout m_layout;
+    DescriptorPool m_pool;
+    DescriptorSet m_set;
+
+    Slots m_sampledImages;
+    Slots m_samplers;
+    Slots m_storageBuffers;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Memory.hpp"
+#include "DeletionQueue.hpp"
+
+using namespace vk;
+
+// Matches the Camera uniform block of vst.vert
+struct CameraUniforms {
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+};
+
+// View projection of every swapchain image in a host visible uniform buffer, read by vst.vert at set 0.
+// Recordings only reference the buffer of their image and the camera is written every frame, after the late latch:
+// static recordings stay valid while the camera moves and the latched camera reaches every draw.
+class CameraBuffers {
+public:
+    void init(const Device &device, const PhysicalDevice &physicalDevice, DeletionQueue &deletionQueue, bool debug);
+    void destroy();
+
+    DescriptorSetLayout getLayout() const;
+
+    // Drops every buffer, the ones still used by frames up to `frame` are freed once it is released
+    void resize(uint32_t imageCount, uint64_t frame);
+
+    // The last frame rendering to the image must have completed
+    void write(uint32_t imageIndex, const glm::mat4 &viewProjection);
+    void bind(const CommandBuffer &commandBuffer, const PipelineLayout &layout, uint32_t imageIndex,
+              uint32_t setIndex = 0) const;
+
+private:
+    struct Entry {
+        AllocatedBuffer buffer;
+        DescriptorSet set;
+    };
+
+    void release(uint64_t frame);
+
+    Device m_device;
+    PhysicalDevice m_physicalDevice;
+    DeletionQueue *m_deletionQueue = nullptr;
+    bool m_debug = false;
+
+    DescriptorSetLayout m_layout;
+    // Sized for the current images, replaced together with them
+    DescriptorPool m_pool;
+    std::vector<Entry> m_entries;
+};
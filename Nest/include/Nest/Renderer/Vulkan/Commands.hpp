@@ -2,18 +2,43 @@
 
 #include <vulkan/vulkan.hpp>
 #include "Swapchain.hpp"
+#include "PushConstants.hpp"
+#include "Pipeline.hpp"
 
 using namespace vk;
 
 struct CommandBufferInputChunk {
     Device device;
     CommandPool commandPool;
-    std::vector<SwapChainFrame> &frames;
+    std::vector<FrameResources> &frames;
 };
 
 CommandPool
 makeCommandPool(const Device &device, const PhysicalDevice &physicalDevice, const SurfaceKHR &surface, bool debug);
 
+CommandPool makeCommandPool(const Device &device, uint32_t queueFamilyIndex, CommandPoolCreateFlags flags, bool debug);
+
 CommandBuffer makeCommandBuffer(const CommandBufferInputChunk &inputChunk);
 
+// Returns an unused secondary command buffer of the pool, allocating one if all are taken
+CommandBuffer acquireSecondaryCommandBuffer(const Device &device, ThreadCommandPool &threadPool);
+
+void resetThreadCommandPool(const Device &device, ThreadCommandPool &threadPool);
+
+struct DrawCommand {
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+    uint32_t firstVertex;
+    uint32_t firstInstance;
+    DrawPushConstants constants;
+    // Id from PipelineLibrary::requestPipeline
+    uint32_t pipelineId = 0;
+    // The dynamic part is set before the draw, the baked part is in the pipeline
+    RasterState rasterState;
+    // Sort order, see makeSortKey
+    uint32_t pass = 0;
+    float depth = 0.0f;
+    bool translucent = false;
+};
+
 void makeFrameCommandBuffers(const CommandBufferInputChunk &inputChunk);
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Destroys objects once the frame counter shows the GPU no longer uses them
+class DeletionQueue {
+public:
+    // The deleter runs as soon as frame `value` has completed
+    void push(uint64_t value, std::function<void()> deleter);
+
+    void flush(uint64_t completedValue);
+
+    // Runs every deleter, only valid after the device went idle
+    void flushAll();
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        uint64_t value;
+        std::function<void()> deleter;
+    };
+
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <unordered_map>
+#include <vector>
+
+using namespace vk;
+
+// One descriptor of a set, either an image or a buffer depending on the type
+struct DescriptorWrite {
+    uint32_t binding;
+    DescriptorType type;
+    DescriptorImageInfo image;
+    DescriptorBufferInfo buffer;
+};
+
+// Hands out classic descriptor sets without ever freeing single sets.
+// Transient sets come from pools owned by a frame in flight, which are reset as a whole once the frame completed.
+// Immutable sets are cached by layout and content and live until destroy().
+// A pool that runs out of memory is not an error: the allocator moves on to a new, larger pool.
+class DescriptorAllocator {
+public:
+    void init(const Device &device, uint32_t framesInFlight, bool debug);
+    void destroy();
+
+    // Recycles every transient set of the frame, only call after the frame's work completed
+    void resetFrame(uint32_t frameIndex);
+
+    // Valid until the frame is reset
+    DescriptorSet allocate(uint32_t frameIndex, const DescriptorSetLayout &layout);
+    DescriptorSet allocate(uint32_t frameIndex, const DescriptorSetLayout &layout,
+                           const std::vector<DescriptorWrite> &writes);
+
+    // Returns the same set for the same layout and writes
+    DescriptorSet getImmutableSet(const DescriptorSetLayout &layout, const std::vector<DescriptorWrite> &writes);
+
+    size_t getPoolCount() const;
+
+private:
+    struct PoolList {
+        std::vector<DescriptorPool> pools;
+        // Pools before this one are full until the next reset
+        size_t current = 0;
+        uint32_t setsPerPool = 0;
+    };
+
+    DescriptorSet allocateFrom(PoolList &list, const DescriptorSetLayout &layout);
+    DescriptorPool makePool(uint32_t maxSets);
+    void write(const DescriptorSet &set, const std::vector<DescriptorWrite> &writes);
+
+    Device m_device;
+    bool m_debug = false;
+    std::vector<PoolList> m_framePools;
+    PoolList m_immutablePools;
+    std::unordered_map<size_t, DescriptorSet> m_immutableSets;
+};
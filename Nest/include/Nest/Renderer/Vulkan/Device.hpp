@@ -6,6 +6,43 @@
 
 using namespace vk;
 
+// Optional device features the renderer can take advantage of
+struct DeviceCapabilities {
+    // Usable version, the device's clamped to the instance's
+    uint32_t apiVersion = 0;
+    // VK_EXT_graphics_pipeline_library
+    bool graphicsPipelineLibrary = false;
+    bool graphicsPipelineLibraryFastLinking = false;
+    // VK_EXT_extended_dynamic_state, VK_EXT_extended_dynamic_state2 and VK_EXT_extended_dynamic_state3
+    bool extendedDynamicState = false;
+    bool extendedDynamicState2 = false;
+    bool extendedDynamicState3PolygonMode = false;
+    bool extendedDynamicState3ColorBlendEnable = false;
+    // VK_EXT_swapchain_maintenance1
+    bool swapchainMaintenance1 = false;
+    // Vulkan 1.2 or VK_KHR_timeline_semaphore
+    bool timelineSemaphore = false;
+    bool timelineSemaphoreExtension = false;
+    // Vulkan 1.3 or VK_KHR_dynamic_rendering
+    bool dynamicRendering = false;
+    bool dynamicRenderingExtension = false;
+    // Vulkan 1.2 or VK_EXT_descriptor_indexing, with everything the bindless heap needs
+    bool descriptorIndexing = false;
+    bool descriptorIndexingExtension = false;
+    // Vulkan 1.3 or VK_KHR_synchronization2
+    bool synchronization2 = false;
+    bool synchronization2Extension = false;
+    // multiDrawIndirect and drawIndirectFirstInstance, needed by the GPU-driven path
+    bool multiDrawIndirect = false;
+    // VK_KHR_draw_indirect_count, enabled through the extension so no Vulkan 1.2 feature structure is needed
+    bool drawIndirectCount = false;
+    // pipelineStatisticsQuery and inheritedQueries, passes execute secondary command buffers while a query is active.
+    // Cleared before device creation unless GlobalSettings::pipelineStatistics is set.
+    bool pipelineStatisticsQuery = false;
+    // VK_KHR_present_id and VK_KHR_present_wait
+    bool presentWait = false;
+};
+
 std::array<bool, 5> getDeviceProperties(const PhysicalDevice &device);
 
 bool
@@ -13,8 +50,12 @@ checkDeviceExtensionSupport(const PhysicalDevice &device, const std::vector<cons
 
 bool isSuitable(const PhysicalDevice &device);
 
-Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKHR &surface, bool debug);
+// Core features are gated on the lower of the device and instance versions
+DeviceCapabilities queryDeviceCapabilities(const PhysicalDevice &physicalDevice, uint32_t instanceApiVersion);
 
-std::array<Queue, 2>
-getQueues(const PhysicalDevice &physicalDevice, const Device &device, const SurfaceKHR &surface, bool debug);
+Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKHR &surface,
+                           const DeviceCapabilities &capabilities, bool debug);
 
+// Graphics, present, async compute and transfer queue, the last two are null if the device has none
+std::array<Queue, 4>
+getQueues(const PhysicalDevice &physicalDevice, const Device &device, const SurfaceKHR &surface, bool debug);
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Nest/Renderer/FrameStats.hpp"
+
+using namespace vk;
+
+// GPU time of named command ranges. Every frame in flight owns a timestamp query pool, the results of a slot are read
+// when the slot records again: its frame has completed by then, so reading never waits on the GPU.
+// Zones also open VK_EXT_debug_utils labels, which show up in capture tools.
+class GpuProfiler {
+public:
+    void init(const Device &device, const PhysicalDevice &physicalDevice, uint32_t queueFamilyIndex,
+              uint32_t framesInFlight, bool debugLabels, const DispatchLoaderDynamic &dld, bool debug);
+    void destroy();
+
+    // Timestamps need a queue family with valid timestamp bits, labels are emitted either way
+    bool isSupported() const;
+
+    // Reads the results the slot wrote last time and records the reset of its queries. Must be the first command of
+    // the frame's command buffer, after the frame's previous submission completed.
+    void beginFrame(uint32_t frameIndex, const CommandBuffer &commandBuffer);
+
+    // Returns the zone index to close, zones past the pool size only get a label
+    uint32_t beginZone(const CommandBuffer &commandBuffer, const char *name);
+    void endZone(const CommandBuffer &commandBuffer, uint32_t zone);
+
+    // Zones of the last frame read back, in the order they were opened
+    const std::vector<GpuZoneStats> &getZones() const;
+    // From the first to the last timestamp of that frame
+    float getFrameMilliseconds() const;
+
+    // Profiler used by GPU_ZONE, null if none is initialized
+    static GpuProfiler *getActive();
+
+private:
+    static constexpr uint32_t maxZonesPerFrame = 128;
+
+    struct Zone {
+        std::string name;
+        uint32_t depth = 0;
+    };
+
+    struct FrameData {
+        QueryPool pool;
+        std::vector<Zone> zones;
+        uint32_t depth = 0;
+    };
+
+    void readResults(FrameData &frame);
+
+    static GpuProfiler *s_active;
+
+    Device m_device;
+    const DispatchLoaderDynamic *m_dld = nullptr;
+    bool m_debug = false;
+    bool m_labels = false;
+    bool m_supported = false;
+    float m_timestampPeriod = 1.0f;
+    uint64_t m_timestampMask = ~0ull;
+
+    std::mutex m_mutex;
+    std::vector<FrameData> m_frames;
+    uint32_t m_frameIndex = 0;
+
+    std::vector<GpuZoneStats> m_results;
+    float m_frameMilliseconds = 0.0f;
+};
+
+// Times the commands recorded until the end of the scope
+class GpuZone {
+public:
+    GpuZone(const CommandBuffer &commandBuffer, const char *name);
+    ~GpuZone();
+
+    GpuZone(const GpuZone &) = delete;
+    GpuZone &operator=(const GpuZone &) = delete;
+
+private:
+    GpuProfiler *m_profiler;
+    CommandBuffer m_commandBuffer;
+    uint32_t m_zone = 0;
+};
+
+#define GPU_ZONE_CONCAT_IMPL(a, b) a##b
+#define GPU_ZONE_CONCAT(a, b) GPU_ZONE_CONCAT_IMPL(a, b)
+#define GPU_ZONE(commandBuffer, name) GpuZone GPU_ZONE_CONCAT(gpuZone, __LINE__)(commandBuffer, name)
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Device.hpp"
+#include "Memory.hpp"
+#include "DescriptorAllocator.hpp"
+#include "RenderGraph.hpp"
+#include "AsyncCompute.hpp"
+#include "UploadQueue.hpp"
+
+using namespace vk;
+
+// Layouts match GpuScene.glsl
+struct GpuMesh {
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t padding = 0;
+};
+
+struct GpuInstance {
+    glm::mat4 transform = glm::mat4(1.0f);
+    // Center in model space and radius
+    glm::vec4 boundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    uint32_t meshIndex = 0;
+    uint32_t materialIndex = 0;
+    uint32_t textureIndex = 0;
+    uint32_t samplerIndex = 0;
+};
+
+// Matches the push_constant block of cull.comp
+struct CullPushConstants {
+    glm::vec4 frustumPlanes[6];
+    uint32_t instanceCount = 0;
+    uint32_t compact = 0;
+    uint32_t padding[2] = {};
+};
+
+// Matches the push_constant block of gpuDriven.vert
+struct GpuDrawPushConstants {
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+};
+
+// Instances which never cost the CPU a draw call: instance and mesh tables live in storage buffers, a compute pass
+// frustum culls every instance and writes the visible ones as indexed indirect commands, and a single
+// vkCmdDrawIndexedIndirectCount renders them. Without VK_KHR_draw_indirect_count culled instances keep their slot
+// with an instance count of zero and vkCmdDrawIndexedIndirect draws all slots.
+// Every frame in flight has its own copy of the buffers, so changing the scene never waits for the GPU.
+// With an async compute queue the culling runs there and the draw commands are handed over to graphics.
+class GpuScene {
+public:
+    void init(const Device &device, const PhysicalDevice &physicalDevice, const DeviceCapabilities &capabilities,
+              DescriptorAllocator &descriptorAllocator, AsyncCompute &asyncCompute, UploadQueue &uploadQueue,
+              uint32_t framesInFlight, const std::string &shaderDirectory, const DispatchLoaderDynamic &dld,
+              bool debug);
+    void destroy();
+
+    // False if the device lacks multi draw indirect or the compiled shaders are missing
+    bool isSupported() const;
+    // Set 0 of the culling and drawing pipelines
+    DescriptorSetLayout getLayout() const;
+
+    // Indices select the vertices of gpuDriven.vert, returns the mesh index
+    uint32_t addMesh(const std::vector<uint32_t> &indices);
+    uint32_t addInstance(const GpuInstance &instance);
+    void setInstance(uint32_t index, const GpuInstance &instance);
+    // Replaces every instance
+    void setInstances(const std::vector<GpuInstance> &instances);
+    uint32_t getInstanceCount() const;
+
+    void setViewProjection(const glm::mat4 &viewProjection);
+    const GpuDrawPushConstants &getDrawPushConstants() const;
+
+    // Uploads the scene for the frame and adds the passes which fill the draw commands, or records them into the
+    // async compute work
+    void addCullPasses(RenderGraph &graph, uint32_t frameIndex);
+    // Declares what draw() reads, from the setup of the pass that calls it
+    void declareDrawReads(RenderGraphBuilder &builder) const;
+    // Records the indirect draw of the frame passed to addCullPasses, expects its pipeline to be bound
+    void draw(const CommandBuffer &commandBuffer, const PipelineLayout &layout) const;
+
+private:
+    struct FrameData {
+        AllocatedBuffer instances;
+        AllocatedBuffer meshes;
+        AllocatedBuffer indices;
+        AllocatedBuffer drawCommands;
+        AllocatedBuffer drawCount;
+        uint64_t geometryVersion = 0;
+        uint64_t instanceVersion = 0;
+        DescriptorSet set;
+    };
+
+    void uploadGeometry(FrameData &frame);
+    void uploadInstances(FrameData &frame);
+    void reserve(AllocatedBuffer &buffer, DeviceSize size, BufferUsageFlags usage, MemoryPropertyFlags properties,
+                 const std::vector<uint32_t> &queueFamilies = {});
+    void recordCull(const CommandBuffer &commandBuffer, const FrameData &frame) const;
+    void recordAsyncCull(FrameData &frame);
+
+    Device m_device;
+    PhysicalDevice m_physicalDevice;
+    DescriptorAllocator *m_descriptorAllocator = nullptr;
+    AsyncCompute *m_asyncCompute = nullptr;
+    UploadQueue *m_uploadQueue = nullptr;
+    const DispatchLoaderDynamic *m_dld = nullptr;
+    bool m_debug = false;
+    bool m_supported = false;
+    bool m_drawIndirectCount = false;
+    uint32_t m_maxDrawCount = 0;
+
+    DescriptorSetLayout m_layout;
+    PipelineLayout m_cullLayout;
+    Pipeline m_cullPipeline;
+
+    std::vector<GpuMesh> m_meshes;
+    std::vector<uint32_t> m_indices;
+    std::vector<GpuInstance> m_instances;
+    // Bumped by every change, frames upload again when theirs is older. Instances change far more often than the
+    // meshes and indices, so they are tracked apart and never cause a geometry upload.
+    uint64_t m_geometryVersion = 1;
+    uint64_t m_instanceVersion = 1;
+
+    std::array<glm::vec4, 6> m_frustumPlanes;
+    GpuDrawPushConstants m_drawConstants;
+
+    std::vector<FrameData> m_frames;
+    uint32_t m_frameIndex = 0;
+};
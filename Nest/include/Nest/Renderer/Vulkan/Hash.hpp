@@ -0,0 +1,16 @@
+#pragma once
+
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+template<typename T>
+inline void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// Raw value of a vulkan.hpp handle, usable as a hash or map key
+template<typename Handle>
+inline uint64_t handleValue(const Handle &handle) {
+    return (uint64_t) static_cast<typename Handle::CType>(handle);
+}
@@ -7,4 +7,7 @@ using namespace vk;
 
 bool supported(const std::vector<const char *> &needExtensions, const std::vector<const char *> &layers);
 
+// Version the instance is created with, the highest the loader supports. Device features above it are unusable.
+uint32_t getInstanceApiVersion();
+
 Instance makeInstanceVulkan(const char *appName);
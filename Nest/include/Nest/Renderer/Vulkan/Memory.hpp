@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+
+using namespace vk;
+
+// Index of a memory type allowed by typeBits with all the requested properties, UINT32_MAX if there is none
+uint32_t findMemoryType(const PhysicalDevice &physicalDevice, uint32_t typeBits, MemoryPropertyFlags properties);
+
+// Buffer with its own allocation, host visible buffers stay mapped for their whole life
+struct AllocatedBuffer {
+    Buffer buffer;
+    DeviceMemory memory;
+    DeviceSize size = 0;
+    void *mapped = nullptr;
+};
+
+// Buffers used by more than one queue family are shared concurrently and need no ownership transfers
+AllocatedBuffer makeBuffer(const Device &device, const PhysicalDevice &physicalDevice, DeviceSize size,
+                           BufferUsageFlags usage, MemoryPropertyFlags properties, bool debug,
+                           const std::vector<uint32_t> &queueFamilies = {});
+
+void destroyBuffer(const Device &device, AllocatedBuffer &buffer);
@@ -1,15 +1,44 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include <vector>
+#include <string>
 
 using namespace vk;
 
+// Rasterization and depth state a material can change
+struct RasterState {
+    PrimitiveTopology topology = PrimitiveTopology::eTriangleList;
+    CullModeFlags cullMode = CullModeFlagBits::eBack;
+    FrontFace frontFace = FrontFace::eClockwise;
+    bool depthTest = false;
+    bool depthWrite = false;
+    CompareOp depthCompareOp = CompareOp::eLessOrEqual;
+    bool primitiveRestart = false;
+    bool depthBias = false;
+    PolygonMode polygonMode = PolygonMode::eFill;
+    bool blendEnable = false;
+
+    bool operator==(const RasterState &other) const = default;
+};
+
+// Parts of RasterState which are set while recording instead of baked into the pipeline
+struct DynamicRasterState {
+    // topology class, cull mode, front face, depth test, write and compare
+    bool extendedDynamicState = false;
+    // primitive restart, depth bias
+    bool extendedDynamicState2 = false;
+    bool polygonMode = false;
+    bool blendEnable = false;
+};
+
 struct GraphicsPipelineInBundle {
     Device device;
     std::string vertexFilepath;
     std::string fragmentFilepath;
-    Extent2D swapchainExtent;
     Format swapchainImageFormat;
+    RasterState rasterState;
+    DynamicRasterState dynamicState;
 };
 
 struct GraphicsPipelineOutBundle {
@@ -18,8 +47,51 @@ struct GraphicsPipelineOutBundle {
     Pipeline pipeline;
 };
 
+// Fixed function state shared by the monolithic pipeline and the pipeline library parts.
+// The create infos point into each other, so the state must not be copied after it is filled.
+struct GraphicsPipelineState {
+    PipelineVertexInputStateCreateInfo vertexInputInfo;
+    PipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
+    // Viewport and scissor are dynamic, so pipelines survive swapchain resizes
+    PipelineViewportStateCreateInfo viewportState;
+    PipelineRasterizationStateCreateInfo rasterizer;
+    PipelineMultisampleStateCreateInfo multisampling;
+    PipelineDepthStencilStateCreateInfo depthStencil;
+    PipelineColorBlendAttachmentState colorBlendAttachment;
+    PipelineColorBlendStateCreateInfo colorBlending;
+    std::vector<DynamicState> dynamicStates;
+    PipelineDynamicStateCreateInfo dynamicState;
+    // Attachment formats, used instead of a render pass with dynamic rendering
+    Format colorAttachmentFormat;
+    PipelineRenderingCreateInfo renderingInfo;
+};
+
+void fillGraphicsPipelineState(const GraphicsPipelineInBundle &specification, GraphicsPipelineState &state);
+
+// Raster state with every dynamic field reset, pipelines which only differ in dynamic state share it
+RasterState getBakedRasterState(const RasterState &rasterState, const DynamicRasterState &dynamicState);
+
+size_t hashRasterState(const RasterState &rasterState);
+
+// Records the dynamic part of the raster state
+void setDynamicRasterState(const CommandBuffer &commandBuffer, const RasterState &rasterState,
+                           const DynamicRasterState &dynamicState, const DispatchLoaderDynamic &dld);
+
+PipelineShaderStageCreateInfo makeShaderStage(const ShaderStageFlagBits &stage, const ShaderModule &module);
+
 GraphicsPipelineOutBundle makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, bool debug);
 
+Pipeline makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, const PipelineLayout &layout,
+                              const RenderPass &renderPass, bool debug);
+
 PipelineLayout makePipelineLayout(const Device &device, bool debug);
 
-RenderPass makeRenderpass(const Device &device, const Format &swapchainImageFormat, bool debug);
\ No newline at end of file
+PipelineLayout makePipelineLayout(const Device &device, const std::vector<DescriptorSetLayout> &setLayouts, bool debug);
+
+PipelineLayout makePipelineLayout(const Device &device, const std::vector<DescriptorSetLayout> &setLayouts,
+                                  const std::vector<PushConstantRange> &pushConstantRanges, bool debug);
+
+RenderPass makeRenderpass(const Device &device, const Format &swapchainImageFormat, bool debug);
+
+Pipeline makeComputePipeline(const Device &device, const PipelineLayout &layout, const std::string &shaderFilepath,
+                             bool debug);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <unordered_map>
+#include <future>
+#include <vector>
+#include <array>
+
+#include "Pipeline.hpp"
+#include "DeletionQueue.hpp"
+
+using namespace vk;
+
+// Builds graphics pipelines out of separately compiled VK_EXT_graphics_pipeline_library parts.
+// Every part is cached, so changing e.g. the render target format only compiles a new fragment
+// output part. A pipeline is first fast-linked from its parts, then a link-time optimized version
+// is compiled in the background and swapped in by update(). Devices without fast linking would
+// compile twice, so they only link the optimized version.
+// Without the extension it falls back to caching monolithic pipelines. In both cases pipelines
+// are keyed only by the state that is baked, dynamic raster state never creates a permutation.
+class PipelineLibrary {
+public:
+    void init(const Device &device, DeletionQueue &deletionQueue, bool useLibrary, bool fastLinking, bool debug);
+    void destroy();
+
+    // Returns an id that stays valid while the underlying pipeline gets replaced
+    uint32_t requestPipeline(const GraphicsPipelineInBundle &specification, const PipelineLayout &layout,
+                             const RenderPass &renderPass);
+
+    Pipeline getPipeline(uint32_t id) const;
+
+    // Distinct pipelines requested so far, reported in FrameStats
+    size_t getPipelineCount() const;
+
+    // Swaps in the optimized pipelines that finished compiling, returns true if any handle changed.
+    // The replaced pipelines are destroyed once frames up to `frame` are released.
+    bool update(uint64_t frame);
+
+private:
+    struct LinkedPipeline {
+        Pipeline current;
+        bool optimized = false;
+        std::future<Pipeline> pending;
+    };
+
+    uint32_t requestMonolithicPipeline(const GraphicsPipelineInBundle &specification, const PipelineLayout &layout,
+                                       const RenderPass &renderPass);
+    Pipeline makeVertexInputPart(const GraphicsPipelineInBundle &specification);
+    Pipeline makePreRasterizationPart(const GraphicsPipelineInBundle &specification, const PipelineLayout &layout,
+                                      const RenderPass &renderPass);
+    Pipeline makeFragmentShaderPart(const GraphicsPipelineInBundle &specification, const PipelineLayout &layout,
+                                    const RenderPass &renderPass);
+    Pipeline makeFragmentOutputPart(const GraphicsPipelineInBundle &specification, const RenderPass &renderPass);
+    Pipeline makePart(GraphicsPipelineCreateInfo &pipelineInfo, GraphicsPipelineLibraryFlagsEXT flags);
+    Pipeline link(const std::array<Pipeline, 4> &parts, const PipelineLayout &layout, bool optimize);
+
+    Device m_device;
+    DeletionQueue *m_deletionQueue = nullptr;
+    PipelineCache m_cache;
+    bool m_useLibrary = false;
+    bool m_fastLinking = false;
+    bool m_debug = false;
+
+    std::unordered_map<size_t, Pipeline> m_vertexInputParts;
+    std::unordered_map<size_t, Pipeline> m_preRasterizationParts;
+    std::unordered_map<size_t, Pipeline> m_fragmentShaderParts;
+    std::unordered_map<size_t, Pipeline> m_fragmentOutputParts;
+
+    std::unordered_map<size_t, uint32_t> m_pipelineIds;
+    std::vector<LinkedPipeline> m_pipelines;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <string>
+#include <vector>
+
+#include "Nest/Renderer/FrameStats.hpp"
+
+using namespace vk;
+
+// Pipeline statistics queries around render graph passes, telling vertex bound passes from fragment bound ones.
+// Like the GPU profiler every frame in flight owns a query pool that is read back when the slot records again.
+// Queries of this type can't nest, so only passes are measured and they must not open one themselves.
+class PipelineStatistics {
+public:
+    // Counters gathered by every query, secondary command buffers executed inside a pass must inherit them
+    static constexpr QueryPipelineStatisticFlags flags = QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+                                                         QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+                                                         QueryPipelineStatisticFlagBits::eClippingPrimitives |
+                                                         QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+                                                         QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+
+    void init(const Device &device, uint32_t framesInFlight, bool debug);
+    void destroy();
+
+    bool isEnabled() const;
+
+    // Reads the results the slot wrote last time and records the reset of its queries, before any pass
+    void beginFrame(uint32_t frameIndex, const CommandBuffer &commandBuffer);
+
+    // Returns the query to end, passes past the pool size aren't measured
+    uint32_t begin(const CommandBuffer &commandBuffer, const std::string &name);
+    void end(const CommandBuffer &commandBuffer, uint32_t query);
+
+    // Passes of the last frame read back
+    const std::vector<PassStatistics> &getPasses() const;
+
+private:
+    static constexpr uint32_t maxPassesPerFrame = 64;
+    // One value per bit set in flags
+    static constexpr uint32_t counterCount = 5;
+
+    struct FrameData {
+        QueryPool pool;
+        std::vector<std::string> passes;
+    };
+
+    void readResults(FrameData &frame);
+
+    Device m_device;
+    bool m_debug = false;
+
+    std::vector<FrameData> m_frames;
+    uint32_t m_frameIndex = 0;
+    std::vector<PassStatistics> m_results;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <glm/glm.hpp>
+#include <type_traits>
+#include <vector>
+
+using namespace vk;
+
+// Per-draw data, matches the push_constant block of vst.vert.
+// Vulkan guarantees at least 128 bytes, larger blocks are rejected by validatePushConstantRanges.
+struct DrawPushConstants {
+    glm::mat4 transform = glm::mat4(1.0f);
+    uint32_t materialIndex = 0;
+    uint32_t instanceOffset = 0;
+    // Slots of the bindless heap
+    uint32_t textureIndex = 0;
+    uint32_t samplerIndex = 0;
+};
+
+template<typename T>
+PushConstantRange makePushConstantRange(ShaderStageFlags stages, uint32_t offset = 0) {
+    static_assert(std::is_trivially_copyable_v<T>, "Push constants are copied byte by byte");
+    static_assert(sizeof(T) % 4 == 0, "Push constant size must be a multiple of 4");
+    return {stages, offset, static_cast<uint32_t>(sizeof(T))};
+}
+
+// Checks the ranges against maxPushConstantsSize of the device
+bool validatePushConstantRanges(const PhysicalDevice &physicalDevice, const std::vector<PushConstantRange> &ranges,
+                                bool debug);
+
+template<typename T>
+void pushConstants(const CommandBuffer &commandBuffer, const PipelineLayout &layout, ShaderStageFlags stages,
+                   const T &data, uint32_t offset = 0) {
+    static_assert(std::is_trivially_copyable_v<T>, "Push constants are copied byte by byte");
+    commandBuffer.pushConstants(layout, stages, offset, sizeof(T), &data);
+}
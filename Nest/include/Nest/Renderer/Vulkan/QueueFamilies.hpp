@@ -9,6 +9,12 @@ using namespace vk;
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    // Compute queue running next to the graphics queue, empty if the device has none.
+    // A dedicated compute family is preferred, then another compute family, then a second graphics queue.
+    std::optional<uint32_t> computeFamily;
+    uint32_t computeQueueIndex = 0;
+    // Family with transfer but neither graphics nor compute, usually backed by a copy engine
+    std::optional<uint32_t> transferFamily;
 
     inline bool isComplete() const {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DeletionQueue.hpp"
+#include "ResourceStateTracker.hpp"
+#include "PipelineStatistics.hpp"
+
+using namespace vk;
+
+// How a pass uses a resource, decides the stages, access masks and image layout of the barriers
+enum class RenderGraphAccess {
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,
+    Sampled,
+    StorageRead,
+    StorageWrite,
+    TransferRead,
+    TransferWrite,
+    IndirectRead,
+    VertexRead
+};
+
+struct RenderGraphTextureDesc {
+    Extent2D extent;
+    Format format = Format::eR8G8B8A8Unorm;
+    // Added to the usage derived from the passes
+    ImageUsageFlags usage;
+};
+
+struct RenderGraphBufferDesc {
+    DeviceSize size = 0;
+    // Added to the usage derived from the passes
+    BufferUsageFlags usage;
+};
+
+class RenderGraph;
+
+// Lets a pass declare the resources it creates, reads and writes
+class RenderGraphBuilder {
+public:
+    void createTexture(const std::string &name, const RenderGraphTextureDesc &desc);
+    void createBuffer(const std::string &name, const RenderGraphBufferDesc &desc);
+    void read(const std::string &name, RenderGraphAccess access);
+    void write(const std::string &name, RenderGraphAccess access);
+    // The pass has effects outside the graph and is never culled
+    void setSideEffect();
+
+private:
+    friend class RenderGraph;
+
+    RenderGraphBuilder(RenderGraph &graph, uint32_t pass);
+
+    RenderGraph &m_graph;
+    uint32_t m_pass;
+};
+
+// Frame graph rebuilt every frame: passes declare reads and writes of named resources, compile() culls passes
+// which contribute nothing to imported resources and places transient resources with disjoint lifetimes in the
+// same memory. Passes run in the order they were added, the state tracker derives the barriers between them and
+// starts a transition right after its producer when passes run in between.
+// Physical resources are reused while the declared resources and their lifetimes stay the same.
+class RenderGraph {
+public:
+    using SetupFunction = std::function<void(RenderGraphBuilder &builder)>;
+    using ExecuteFunction = std::function<void(const CommandBuffer &commandBuffer)>;
+
+    void init(const Device &device, const PhysicalDevice &physicalDevice, DeletionQueue &deletionQueue,
+              ResourceStateTracker &stateTracker, bool debug);
+    void destroy();
+
+    // Starts declaring the passes of a frame, replaced physical resources are kept until that frame completed
+    void reset(uint64_t frame);
+
+    // Resource owned outside the graph, e.g. a swapchain image, left in finalLayout after the last pass
+    void importTexture(const std::string &name, const Image &image, const ImageView &imageView,
+                       const RenderGraphTextureDesc &desc, ImageLayout initialLayout, ImageLayout finalLayout);
+    void importBuffer(const std::string &name, const Buffer &buffer, const RenderGraphBufferDesc &desc);
+
+    void addPass(const std::string &name, const SetupFunction &setup, const ExecuteFunction &execute);
+
+    void compile();
+    void execute(const CommandBuffer &commandBuffer) const;
+    // Wraps every executed pass in a pipeline statistics query, null turns it off
+    void setPipelineStatistics(PipelineStatistics *statistics);
+
+    Image getImage(const std::string &name) const;
+    ImageView getImageView(const std::string &name) const;
+    Buffer getBuffer(const std::string &name) const;
+
+    // Bytes the transient resources need on their own and after aliasing
+    DeviceSize getTransientSize() const;
+    DeviceSize getAllocatedSize() const;
+
+    std::string dumpGraphviz() const;
+    std::string dumpJson() const;
+
+private:
+    friend class RenderGraphBuilder;
+
+    struct Resource {
+        std::string name;
+        bool isTexture = true;
+        bool imported = false;
+        RenderGraphTextureDesc texture;
+        RenderGraphBufferDesc buffer;
+        ImageLayout initialLayout = ImageLayout::eUndefined;
+        ImageLayout finalLayout = ImageLayout::eUndefined;
+        // Filled by compile()
+        ImageUsageFlags imageUsage;
+        BufferUsageFlags bufferUsage;
+        uint32_t readCount = 0;
+        int firstPass = -1;
+        int lastPass = -1;
+        int block = -1;
+        DeviceSize size = 0;
+        Image image;
+        ImageView imageView;
+        Buffer bufferHandle;
+    };
+
+    struct Access {
+        uint32_t resource;
+        RenderGraphAccess access;
+        bool write;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<Access> accesses;
+        ExecuteFunction execute;
+        bool sideEffect = false;
+        bool culled = false;
+        uint32_t writeCount = 0;
+        // Next accesses of resources used by later passes, released after this one, filled by compile()
+        std::vector<Access> releases;
+    };
+
+    // Physical objects of the transient resources, shared between frames with the same layout
+    struct PhysicalResources {
+        struct Placement {
+            int block = -1;
+            DeviceSize size = 0;
+        };
+
+        size_t key = 0;
+        std::vector<DeviceMemory> memory;
+        std::vector<DeviceSize> blockSizes;
+        std::unordered_map<std::string, Image> images;
+        std::unordered_map<std::string, ImageView> imageViews;
+        std::unordered_map<std::string, Buffer> buffers;
+        // Block and size of every transient resource, restored when the next frame reuses the objects
+        std::unordered_map<std::string, Placement> placements;
+    };
+
+    uint32_t addResource(const Resource &resource);
+    uint32_t findResource(const std::string &name) const;
+    void cullPasses();
+    void computeLifetimes();
+    size_t hashTransientResources() const;
+    void createPhysicalResources();
+    void releasePhysicalResources();
+    void computeReleases();
+    ResourceState getState(const Access &access) const;
+
+    Device m_device;
+    PhysicalDevice m_physicalDevice;
+    DeletionQueue *m_deletionQueue = nullptr;
+    ResourceStateTracker *m_stateTracker = nullptr;
+    PipelineStatistics *m_statistics = nullptr;
+    bool m_debug = false;
+    uint64_t m_frame = 0;
+
+    std::vector<Resource> m_resources;
+    std::unordered_map<std::string, uint32_t> m_resourceIds;
+    std::vector<Pass> m_passes;
+
+    PhysicalResources m_physical;
+};
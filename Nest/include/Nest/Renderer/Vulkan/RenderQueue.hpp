@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 64 bit draw order, most significant bits first:
+//   pass (4) | translucent (1) | pipeline (12) | material (20) | depth (27)            opaque, front to back
+//   pass (4) | translucent (1) | inverted depth (27) | pipeline (12) | material (20)   translucent, back to front
+// Opaque draws are grouped by state and only ordered by depth inside a group, translucent draws have to blend in
+// depth order and only share state between neighbours at the same depth.
+uint64_t makeSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth, bool translucent);
+
+struct RenderQueueItem {
+    uint64_t key;
+    uint32_t drawIndex;
+};
+
+// Draw indices ordered by their sort key, refilled every frame
+class RenderQueue {
+public:
+    void clear();
+    void push(uint64_t key, uint32_t drawIndex);
+
+    // Stable LSD radix sort over 8 bit digits. Histograms and scatters of large queues are split over the job
+    // system, digits that every key shares are skipped.
+    void sort();
+
+    const std::vector<RenderQueueItem> &getItems() const;
+    size_t size() const;
+
+private:
+    // Below this many items per job the sort runs on the calling thread only
+    static constexpr uint32_t minItemsPerSortJob = 4096;
+
+    std::vector<RenderQueueItem> m_items;
+    std::vector<RenderQueueItem> m_scratch;
+};
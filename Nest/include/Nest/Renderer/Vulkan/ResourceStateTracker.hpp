@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <unordered_map>
+#include <vector>
+
+using namespace vk;
+
+// How a resource is about to be used, or how it was last used when its state is set from outside
+struct ResourceState {
+    PipelineStageFlags2 stages;
+    AccessFlags2 access;
+    // Ignored for buffers
+    ImageLayout layout = ImageLayout::eUndefined;
+};
+
+// Remembers the last writes, reads and layout of every image and buffer it was told about and turns each use into
+// the smallest barrier that makes it safe: reads after reads need none, reads in stages that already saw the last
+// write need none, writes after reads only need an execution dependency. Barriers queued between two flushes are
+// recorded as one vkCmdPipelineBarrier2, or one vkCmdPipelineBarrier without synchronization2.
+// A release records the transition to the next state right after the producer through an event, so the work in
+// between overlaps with it and the use only waits for the event.
+class ResourceStateTracker {
+public:
+    void init(const Device &device, bool synchronization2, uint32_t framesInFlight, const DispatchLoaderDynamic &dld,
+              bool debug);
+    void destroy();
+
+    // Recycles the events of the frame slot, its previous frame has completed
+    void beginFrame(uint32_t frameIndex);
+
+    // State of a resource whose previous use is not tracked, e.g. an image which was just acquired or created
+    void setImageState(const Image &image, ImageAspectFlags aspect, const ResourceState &state);
+    void setBufferState(const Buffer &buffer, const ResourceState &state);
+    // Everything the next use has to wait for, a layout of undefined if the image is unknown
+    ResourceState getImageState(const Image &image) const;
+    ResourceState getBufferState(const Buffer &buffer) const;
+    void removeImage(const Image &image);
+    void removeBuffer(const Buffer &buffer);
+
+    void useImage(const Image &image, const ResourceState &state);
+    void useBuffer(const Buffer &buffer, const ResourceState &state);
+
+    // Split barriers, ignored without synchronization2 where the use records an ordinary barrier
+    void releaseImage(const Image &image, const ResourceState &state);
+    void releaseBuffer(const Buffer &buffer, const ResourceState &state);
+
+    // Records the queued barriers, event waits of the uses and event signals of the releases
+    void flush(const CommandBuffer &commandBuffer);
+
+    // Barriers recorded since init, merged batches count once
+    uint64_t getBarrierCount() const;
+
+private:
+    struct TrackedState {
+        ImageLayout layout = ImageLayout::eUndefined;
+        // Last write or layout transition
+        PipelineStageFlags2 writeStages;
+        AccessFlags2 writeAccess;
+        // Reads since then
+        PipelineStageFlags2 readStages;
+        // Stages which are already ordered after the last write
+        PipelineStageFlags2 visibleStages;
+        // Index of the barrier queued in batch pendingBatch, merged with further uses of the same batch
+        uint64_t pendingBatch = 0;
+        uint32_t pendingBarrier = 0;
+        // Event of a release which was not waited for yet and the state it released to
+        int splitEvent = -1;
+        ResourceState released;
+    };
+
+    struct TrackedImage {
+        ImageAspectFlags aspect = ImageAspectFlagBits::eColor;
+        TrackedState state;
+    };
+
+    struct Batch {
+        std::vector<ImageMemoryBarrier2> imageBarriers;
+        std::vector<BufferMemoryBarrier2> bufferBarriers;
+    };
+
+    struct SplitEvent {
+        Event event;
+        // The wait has to repeat the dependency of the signal
+        Batch batch;
+    };
+
+    struct FrameEvents {
+        std::vector<SplitEvent> events;
+        uint32_t used = 0;
+    };
+
+    static bool transition(TrackedState &state, const ResourceState &next, bool isImage,
+                           PipelineStageFlags2 &srcStages, AccessFlags2 &srcAccess);
+    static void resetState(TrackedState &state, const ResourceState &next);
+    // Returns true if the use is covered by the release it waits for
+    bool waitSplit(TrackedState &state, const ResourceState &next);
+    uint32_t acquireEvent();
+    void recordBatch(const CommandBuffer &commandBuffer, const Batch &batch);
+
+    Device m_device;
+    const DispatchLoaderDynamic *m_dld = nullptr;
+    bool m_synchronization2 = false;
+    bool m_debug = false;
+
+    std::unordered_map<VkImage, TrackedImage> m_images;
+    std::unordered_map<VkBuffer, TrackedState> m_buffers;
+
+    Batch m_batch;
+    Batch m_releaseBatch;
+    uint64_t m_batchId = 1;
+    int m_releaseEvent = -1;
+    std::vector<uint32_t> m_waitEvents;
+
+    std::vector<FrameEvents> m_frameEvents;
+    uint32_t m_frameIndex = 0;
+    uint64_t m_barrierCount = 0;
+};
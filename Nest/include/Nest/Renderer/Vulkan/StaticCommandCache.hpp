@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+
+#include "Nest/Renderer/FrameStats.hpp"
+#include "DeletionQueue.hpp"
+
+using namespace vk;
+
+// Secondary command buffers holding the main pass contents of every swapchain image. A recording is replayed
+// until invalidate() marks it stale, then the image records it again the next time it is rendered.
+class StaticCommandCache {
+public:
+    void init(const Device &device, uint32_t queueFamilyIndex, DeletionQueue &deletionQueue, bool debug);
+    void destroy();
+
+    // Drops every recording, buffers still used by frames up to `frame` are freed once it is released
+    void resize(uint32_t imageCount, uint64_t frame);
+    void invalidate();
+
+    // Null if the image has no up to date recording
+    CommandBuffer get(uint32_t imageIndex) const;
+    // Draw and bind counters of the recording, the other fields are left empty
+    const FrameStats &getStats(uint32_t imageIndex) const;
+
+    // The previous recording of the image must no longer be used by the GPU
+    CommandBuffer begin(uint32_t imageIndex, const CommandBufferInheritanceInfo &inheritanceInfo);
+    void end(uint32_t imageIndex, const FrameStats &stats);
+
+private:
+    struct Entry {
+        CommandBuffer commandBuffer;
+        FrameStats stats;
+        // Version the recording was made at, 0 if there is none
+        uint64_t version = 0;
+    };
+
+    Device m_device;
+    CommandPool m_pool;
+    DeletionQueue *m_deletionQueue = nullptr;
+    bool m_debug = false;
+
+    std::vector<Entry> m_entries;
+    uint64_t m_version = 1;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+
+using namespace vk;
+
+// Gathers the queue work of a frame and sends each queue's share with a single vkQueueSubmit2, or vkQueueSubmit
+// without synchronization2. Consecutive command buffers share a batch, a wait after command buffers or a command
+// buffer after a signal starts the next batch of the same call.
+class SubmitBatcher {
+public:
+    void init(bool synchronization2, bool timelineSemaphore, const DispatchLoaderDynamic &dld, bool debug);
+
+    // Values are ignored for binary semaphores
+    void wait(const Queue &queue, const Semaphore &semaphore, PipelineStageFlags2 stages, uint64_t value = 0);
+    void submit(const Queue &queue, const CommandBuffer &commandBuffer);
+    void signal(const Queue &queue, const Semaphore &semaphore, uint64_t value = 0,
+                PipelineStageFlags2 stages = PipelineStageFlagBits2::eAllCommands);
+
+    // Submits the work gathered for the queue, the fence is signaled once all of it completed
+    bool flush(const Queue &queue, const Fence &fence = nullptr);
+    // Submits the work of every queue
+    bool flushAll();
+
+    // Submit calls and batches since the last resetStats
+    uint32_t getSubmitCount() const;
+    uint32_t getBatchCount() const;
+    void resetStats();
+
+private:
+    struct Batch {
+        std::vector<SemaphoreSubmitInfo> waits;
+        std::vector<CommandBufferSubmitInfo> commandBuffers;
+        std::vector<SemaphoreSubmitInfo> signals;
+    };
+
+    struct QueueWork {
+        Queue queue;
+        std::vector<Batch> batches;
+    };
+
+    QueueWork &getWork(const Queue &queue);
+    void submitLegacy(const QueueWork &work, const Fence &fence) const;
+
+    const DispatchLoaderDynamic *m_dld = nullptr;
+    bool m_synchronization2 = false;
+    bool m_timelineSemaphore = false;
+    bool m_debug = false;
+
+    std::vector<QueueWork> m_work;
+    uint32_t m_submitCount = 0;
+    uint32_t m_batchCount = 0;
+};
@@ -11,17 +11,41 @@ struct SwapChainSupportDetails {
     std::vector<PresentModeKHR> presentModes;
 };
 
+// Resources of a single swapchain image
 struct SwapChainFrame {
     Image image;
     ImageView imageView;
     Framebuffer framebuffer;
+    // Waited by the present of this image, so it has to live as long as the image
+    Semaphore renderFinished;
+    // Number of the last frame rendering to this image
+    uint64_t renderingFrame = 0;
+};
+
+// Command pool owned by one recording thread, reset as a whole once its frame completed
+struct ThreadCommandPool {
+    CommandPool pool;
+    std::vector<CommandBuffer> secondaryCommandBuffers;
+    uint32_t usedSecondaryCommandBuffers = 0;
+};
+
+// Resources of a single frame in flight, independent of the swapchain images
+struct FrameResources {
     CommandBuffer commandBuffer;
-    Semaphore imageAvailable, renderFinished;
+    // One per job system thread
+    std::vector<ThreadCommandPool> threadPools;
+    Semaphore imageAvailable;
+    // Only used when timeline semaphores are not available
     Fence inFlight;
+    // VK_EXT_swapchain_maintenance1 fence signaled once the present of this frame released its resources
+    Fence presentFence;
+    // Number of the last frame submitted with these objects
+    uint64_t submittedFrame = 0;
 };
 
 struct SwapChainBundle {
     SwapchainKHR swapchain;
+    PresentModeKHR presentMode;
     std::vector<SwapChainFrame> frames;
     Format format;
     Extent2D extent;
@@ -31,12 +55,14 @@ SwapChainSupportDetails querySwapchainSupport(const PhysicalDevice &device, cons
 
 SurfaceFormatKHR chooseSwapchainSurfaceFormat(const std::vector<SurfaceFormatKHR> &formats);
 
-PresentModeKHR chooseSwapchainPresentMode(const std::vector<PresentModeKHR> &presentModes);
+// The requested mode if the surface supports it, FIFO otherwise, which every surface supports
+PresentModeKHR chooseSwapchainPresentMode(const std::vector<PresentModeKHR> &presentModes, PresentModeKHR requested);
 
 Extent2D chooseSwapchainExtent(uint32_t width, uint32_t height, const SurfaceCapabilitiesKHR &capabilities);
 
 SwapChainBundle
-createSwapchain(Device logicalDevice, PhysicalDevice physicalDevice, SurfaceKHR surface, int width, int height, SwapchainKHR *oldSwapchain = nullptr);
+createSwapchain(Device logicalDevice, PhysicalDevice physicalDevice, SurfaceKHR surface, int width, int height,
+                PresentModeKHR presentMode, SwapchainKHR *oldSwapchain = nullptr);
 
 
 
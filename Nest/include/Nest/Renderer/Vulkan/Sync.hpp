@@ -1,10 +1,35 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include <vector>
 
 using namespace vk;
 
 // synchronization
 Semaphore makeSemaphore(const Device &device, bool debug);
 
-Fence makeFence(const Device &device, bool debug);
\ No newline at end of file
+Fence makeFence(const Device &device, bool debug);
+
+// Stages for the original synchronization commands, stages only synchronization2 knows widen to all commands
+PipelineStageFlags toLegacyStages(PipelineStageFlags2 stages, PipelineStageFlagBits empty);
+// Access for the original synchronization commands, split shader reads and writes fold into the generic ones
+AccessFlags toLegacyAccess(AccessFlags2 access);
+// One vkCmdPipelineBarrier2, or one vkCmdPipelineBarrier with the converted barriers without synchronization2
+void recordBarriers(const CommandBuffer &commandBuffer, const std::vector<ImageMemoryBarrier2> &imageBarriers,
+                    const std::vector<BufferMemoryBarrier2> &bufferBarriers, bool synchronization2,
+                    const DispatchLoaderDynamic &dld);
+
+// Vulkan 1.2 timeline semaphore, its counter only ever grows
+Semaphore makeTimelineSemaphore(const Device &device, uint64_t initialValue, bool debug);
+
+// Progress of the work submitted to a queue, the timeline counts submissions
+struct QueueTimeline {
+    Semaphore semaphore;
+    uint64_t submittedValue = 0;
+    uint64_t completedValue = 0;
+};
+
+// Reads the counter without blocking and returns the completed value
+uint64_t pollTimeline(const Device &device, QueueTimeline &timeline, const DispatchLoaderDynamic &dld);
+
+void waitTimeline(const Device &device, QueueTimeline &timeline, uint64_t value, const DispatchLoaderDynamic &dld);
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Memory.hpp"
+#include "QueueFamilies.hpp"
+#include "SubmitBatcher.hpp"
+
+using namespace vk;
+
+// Copies data into device local buffers and images from any thread, each thread records into a command pool of its
+// own. With a transfer only queue family and timeline semaphores every upload is submitted to the transfer queue
+// right away and signals the upload timeline with its number. Ownership moves to graphics through a release after
+// the copy and an acquire recorded by the next frame, which also waits for the timeline.
+// Otherwise uploads are submitted to the graphics queue in front of the next frame and complete with it.
+class UploadQueue {
+public:
+    void init(const Device &device, const PhysicalDevice &physicalDevice, const QueueFamilyIndices &indices,
+              const Queue &transferQueue, bool timelineSemaphore, bool synchronization2,
+              const DispatchLoaderDynamic &dld, bool debug);
+    // The device has to be idle
+    void destroy();
+
+    // True if uploads run on the transfer queue
+    bool isDedicated() const;
+
+    // Return the upload number for isComplete, the data is visible to graphics at dstStages from the next frame on.
+    // The destination is used by nothing else until then.
+    uint64_t uploadBuffer(const Buffer &buffer, DeviceSize offset, const void *data, DeviceSize size,
+                          PipelineStageFlags2 dstStages, AccessFlags2 dstAccess);
+    // Fills mip 0 of a color image and leaves it in layout
+    uint64_t uploadImage(const Image &image, const Extent3D &extent, const void *data, DeviceSize size,
+                         ImageLayout layout, PipelineStageFlags2 dstStages, AccessFlags2 dstAccess);
+    bool isComplete(uint64_t upload) const;
+
+    // Render thread only: records the acquires of the uploads submitted so far into the frame
+    void acquire(const CommandBuffer &commandBuffer);
+    // Adds the wait for the acquired uploads, or the pending uploads themselves, in front of the graphics work of
+    // the frame numbered frame
+    void submit(SubmitBatcher &batcher, const Queue &graphicsQueue, uint64_t frame);
+    // Marks the uploads of completed frames as complete
+    void update(uint64_t completedFrame);
+
+private:
+    // Halves of ownership transfers recorded by a frame once the upload was submitted
+    struct Acquires {
+        std::vector<BufferMemoryBarrier2> buffers;
+        std::vector<ImageMemoryBarrier2> images;
+    };
+
+    struct PendingUpload {
+        uint64_t upload;
+        CommandBuffer commandBuffer;
+        AllocatedBuffer staging;
+    };
+
+    // Owned by one loader thread, only that thread records into the pool and frees its command buffers
+    struct ThreadUploader {
+        CommandPool pool;
+        std::vector<PendingUpload> pending;
+    };
+
+    ThreadUploader &getThreadUploader();
+    // Records the copy into a new command buffer of the calling thread and submits it
+    template<typename Record>
+    uint64_t upload(const void *data, DeviceSize size, Record &&record);
+    void recordTransfer(const CommandBuffer &commandBuffer, const BufferMemoryBarrier2 *bufferBarrier,
+                        const ImageMemoryBarrier2 *imageBarrier, Acquires &acquires) const;
+
+    Device m_device;
+    PhysicalDevice m_physicalDevice;
+    Queue m_transferQueue;
+    uint32_t m_uploadFamily = 0;
+    uint32_t m_graphicsFamily = 0;
+    bool m_dedicated = false;
+    bool m_synchronization2 = false;
+    const DispatchLoaderDynamic *m_dld = nullptr;
+    bool m_debug = false;
+    Semaphore m_timeline;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::thread::id, ThreadUploader> m_threads;
+    uint64_t m_submittedUpload = 0;
+    std::atomic<uint64_t> m_completedUpload = 0;
+    // Transfer queue: acquires not recorded by a frame yet
+    Acquires m_acquires;
+    uint64_t m_acquiredUpload = 0;
+    // Graphics queue: uploads waiting for the next frame, and the last upload submitted with each frame
+    std::vector<CommandBuffer> m_pendingSubmits;
+    std::vector<std::pair<uint64_t, uint64_t>> m_frameUploads;
+};
@@ -5,7 +5,26 @@
 #include <string>
 
 #include "Nest/Renderer/Renderer.hpp"
+#include "Nest/Renderer/StallDetector.hpp"
+#include "Nest/Renderer/LatencyTracker.hpp"
 #include "Swapchain.hpp"
+#include "Device.hpp"
+#include "PipelineLibrary.hpp"
+#include "Sync.hpp"
+#include "DeletionQueue.hpp"
+#include "Commands.hpp"
+#include "BindlessHeap.hpp"
+#include "DescriptorAllocator.hpp"
+#include "RenderGraph.hpp"
+#include "GpuScene.hpp"
+#include "CameraBuffers.hpp"
+#include "RenderQueue.hpp"
+#include "StaticCommandCache.hpp"
+#include "SubmitBatcher.hpp"
+#include "AsyncCompute.hpp"
+#include "UploadQueue.hpp"
+#include "GpuProfiler.hpp"
+#include "PipelineStatistics.hpp"
 
 using namespace vk;
 
@@ -16,13 +35,19 @@ public:
     ~Vulkan() override;
 
     void init(const GlobalSettings &globalSettings) override;
-    void render() override;
+    void render(const RenderPacket &packet) override;
+    void resize(int width, int height) override;
+    const FrameStats &getFrameStats() const override;
 private:
     void makeInstance();
 
     void makeDevice();
     void makeSwapchain();
-    void recreateSwapchain();
+    bool recreateSwapchain();
+    // Blocks until the present with the id or a later one is on screen
+    void waitForPresent(uint64_t presentId);
+    void destroySwapchainFrames(const std::vector<SwapChainFrame> &frames);
+    void retireSwapchain();
     void cleanupSwapchain();
 
     void makePipeline();
@@ -30,8 +55,24 @@ private:
     void finalizeSetup();
     void makeFramebuffer();
     void makeFrameSync();
-
-    void recordDrawCommands(const CommandBuffer &commandBuffer, uint32_t imageIndex);
+    void makeImageSync();
+    void waitForFrame(uint64_t frame);
+    uint64_t getReleasedFrame() const;
+
+    void makeThreadCommandPools();
+
+    void buildRenderGraph(uint32_t imageIndex, FrameResources &frame);
+    void recordDrawCommands(const CommandBuffer &commandBuffer);
+    void recordMainPass(const CommandBuffer &commandBuffer, uint32_t imageIndex, FrameResources &frame);
+    void makeInheritanceInfo(uint32_t imageIndex, CommandBufferInheritanceInfo &inheritanceInfo,
+                             CommandBufferInheritanceRenderingInfo &renderingInfo) const;
+    void beginRenderTarget(const CommandBuffer &commandBuffer, uint32_t imageIndex, bool secondaryContents);
+    void endRenderTarget(const CommandBuffer &commandBuffer, uint32_t imageIndex);
+    void applyPacket(const RenderPacket &packet);
+    void buildRenderQueue();
+    void recordDraws(const CommandBuffer &commandBuffer, uint32_t imageIndex, uint32_t firstItem, uint32_t lastItem,
+                     FrameStats &stats);
+    void recordGpuDrivenDraws(const CommandBuffer &commandBuffer, FrameStats &stats);
 
     GlobalSettings m_globalSettings;
 
@@ -43,23 +84,83 @@ private:
 
     // Device-related variables
     PhysicalDevice physicalDevice;
+    DeviceCapabilities capabilities;
     Device logicalDevice;
     Queue graphicsQueue;
     Queue presentQueue;
+    // Null if the device has no separate compute queue
+    Queue computeQueue;
+    // Null if the device has no transfer only queue family
+    Queue transferQueue;
     SwapchainKHR swapchain;
     std::vector<SwapChainFrame> swapchainFrames;
     Format swapchainFormat;
     Extent2D swapchainExtent;
+    bool swapchainOutdated = false;
+    // Present ids are frame numbers, earlier ones were presented to a retired swapchain
+    uint64_t swapchainFirstPresentId = 1;
 
     // Pipeline-related variables
+    BindlessHeap bindlessHeap;
+    CameraBuffers cameraBuffers;
+    DescriptorAllocator descriptorAllocator;
     PipelineLayout pipelineLayout;
+    // Stages receiving DrawPushConstants, empty if the device can't fit them
+    ShaderStageFlags drawPushConstantStages;
     RenderPass renderPass;
     Pipeline pipeline;
+    PipelineLibrary pipelineLibrary;
+    uint32_t pipelineId;
+    // The default pipeline, draws request their permutations from it
+    GraphicsPipelineInBundle pipelineSpecification;
+    RasterState rasterState;
+    DynamicRasterState dynamicRasterState;
+    // Instances culled and drawn by the GPU, rendered after drawCommands in the same pass
+    GpuScene gpuScene;
+    PipelineLayout gpuDrivenPipelineLayout;
+    Pipeline gpuDrivenPipeline;
+    uint32_t gpuDrivenPipelineId;
+    bool gpuDrivenFrame = false;
 
     // Command-related variables
     CommandPool commandPool; // responsible for memory allocation
     CommandBuffer mainCommandBuffer;
+    std::vector<DrawCommand> drawCommands;
+    // Draws added by finalizeSetup, the draws of the packet follow them
+    size_t setupDrawCount = 0;
+    std::vector<RenderDraw> packetDraws;
+    std::vector<RenderInstance> packetInstances;
+    // drawCommands in the order they are recorded
+    RenderQueue renderQueue;
+    // Set whenever drawCommands change, the queue is sorted and static recordings are invalidated again
+    bool drawCommandsDirty = true;
+    StaticCommandCache staticCommands;
+    FrameStats frameStats;
+    GpuProfiler gpuProfiler;
+    PipelineStatistics pipelineStatistics;
+    StallDetector stallDetector;
+    LatencyTracker latencyTracker;
+    // Rebuilt every frame, owns the layout transitions of the swapchain image
+    RenderGraph renderGraph;
+    ResourceStateTracker stateTracker;
+    // Draws recorded by one job, below this the frame is recorded on the calling thread
+    static constexpr uint32_t minDrawsPerRecordingJob = 256;
+
+    // Queue work of the frame, sent with as few submit calls as possible
+    SubmitBatcher submitBatcher;
+    // Compute work overlapping with graphics, culling of the GPU-driven path runs there
+    AsyncCompute asyncCompute;
+    // Staging copies into device local memory, callable from loader threads
+    UploadQueue uploadQueue;
 
     // Synchronization objects
+    std::vector<FrameResources> frames;
     int maxFramesInFlight, frameNumber;
+    // Signaled with the frame number by every graphics submission
+    QueueTimeline graphicsTimeline;
+    uint64_t submittedFrames = 0;
+    uint64_t completedFrames = 0;
+    uint64_t presentedFrames = 0;
+    // Objects waiting for the frames that use them to be released
+    DeletionQueue deletionQueue;
 };
\ No newline at end of file
@@ -12,4 +12,5 @@
 
 #define VK_PRINT_SWAPCHAIN_INFO 0
 #define VK_PRINT_GRAPTHICS_PIPELINE_INFO 0
-#define VK_PRINT_COMMANDBUFFER_INFO 0
\ No newline at end of file
+#define VK_PRINT_COMMANDBUFFER_INFO 0
+#define VK_PRINT_RENDER_GRAPH 0
\ No newline at end of file
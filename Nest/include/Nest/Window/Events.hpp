@@ -1,11 +1,20 @@
 #pragma once
 
 #include <cstdint>
+#include <mutex>
+#include <thread>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 
 #include "Nest/Window/Key.hpp"
 
+// Newest cursor position and the oldest input event not reflected by a frame yet
+struct CursorLatch {
+    glm::vec2 position;
+    // Events::getTime() of that event, 0 if there was none
+    double inputTime;
+};
+
 class Events final {
 public:
     static void init(void* handle);
@@ -15,9 +24,19 @@ public:
     static bool isJustKeyPressed(Key key);
     static bool isMouseButtonPressed(MouseButton mouseButton);
     static bool isJustMouseButtonPressed(MouseButton mouseButton);
+    static bool isJustFramebufferResized();
+    static glm::ivec2 getFramebufferSize();
     static void toggleCursorLock();
     static bool isCursorLocked();
     static void pollEvents();
+    // Sleeps until an event arrives, events stay in the current frame
+    static void waitEvents();
+    // Time of the oldest input event since the last call, 0 if there was none
+    static double consumeInputTime();
+    // Like consumeInputTime, together with the position of the last cursor event. Callable from any thread, on the
+    // main thread it polls first: nothing else does between filling the packet and rendering it there. Events of
+    // that poll count towards the next frame.
+    static CursorLatch latchCursor();
 private:
     static void* m_handle;
     static bool cursorLocked;
@@ -26,6 +45,18 @@ private:
     static bool mouseButtons[8];
     static uint32_t framesMouseButtons[8];
     static uint32_t frame;
+    // Frame the callbacks stamp events with, the next one while latchCursor polls
+    static uint32_t eventFrame;
+    static std::thread::id mainThread;
+    static int framebufferWidth, framebufferHeight;
+    static uint32_t framesFramebufferResized;
+    // Written by the callbacks, read by render thread latches
+    static std::mutex inputMutex;
+    static glm::vec2 cursorPosition;
+    static double pendingInputTime;
+    static void markInput();
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void mouseCallback(GLFWwindow* window, int button, int action, int mode);
+    static void cursorPosCallback(GLFWwindow* window, double x, double y);
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 };
\ No newline at end of file
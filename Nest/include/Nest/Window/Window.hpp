@@ -9,7 +9,6 @@ public:
     void init(const char* name, int resolutionX, int resolutionY, bool fullScreen);
     bool shouldClose();
     void setShouldClose();
-    void swapBuffers();
     glm::vec2 getSize();
     double getTime();
     void* getNativeHandle();
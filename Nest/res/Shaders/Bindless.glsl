@@ -0,0 +1,14 @@
+// Declarations matching BindlessHeap, include after enabling GL_EXT_nonuniform_qualifier.
+// The heap is bound at set 1, set 0 holds the camera of vst.vert.
+// Resources are picked with indices passed per draw, wrap them in nonuniformEXT() when they vary per invocation.
+
+layout(set = 1, binding = 0) uniform texture2D bindlessTextures[];
+layout(set = 1, binding = 1) uniform sampler bindlessSamplers[];
+layout(set = 1, binding = 2) readonly buffer BindlessBuffer {
+    uint data[];
+} bindlessBuffers[];
+
+vec4 sampleBindless(uint textureIndex, uint samplerIndex, vec2 uv) {
+    return texture(sampler2D(bindlessTextures[nonuniformEXT(textureIndex)],
+                             bindlessSamplers[nonuniformEXT(samplerIndex)]), uv);
+}
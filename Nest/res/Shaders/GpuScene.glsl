@@ -0,0 +1,22 @@
+// Declarations matching GpuScene.hpp, every structure is tightly packed under std430.
+
+struct GpuMesh {
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint padding;
+};
+
+struct GpuInstance {
+    mat4 transform;
+    // Center in model space and radius
+    vec4 boundingSphere;
+    uint meshIndex;
+    uint materialIndex;
+    uint textureIndex;
+    uint samplerIndex;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    GpuInstance instances[];
+};
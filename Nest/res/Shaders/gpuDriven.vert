@@ -0,0 +1,29 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "GpuScene.glsl"
+
+vec2 positions[3] = vec2[](
+vec2(0.0, -0.5),
+vec2(0.5, 0.5),
+vec2(-0.5, 0.5)
+);
+
+vec3 colors[3] = vec3[](
+vec3(1.0, 0.0, 0.0),
+vec3(0.0, 1.0, 0.0),
+vec3(0.0, 0.0, 1.0)
+);
+
+layout(push_constant) uniform GpuDrawPushConstants {
+    mat4 viewProjection;
+} draw;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    GpuInstance instance = instances[gl_InstanceIndex];
+    uint vertex = uint(gl_VertexIndex) % 3;
+    gl_Position = draw.viewProjection * instance.transform * vec4(positions[vertex], 0.0, 1.0);
+    fragColor = colors[vertex];
+}
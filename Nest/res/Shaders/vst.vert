@@ -12,9 +12,22 @@ vec3(0.0, 1.0, 0.0),
 vec3(0.0, 0.0, 1.0)
 );
 
+// Written by CameraBuffers every frame, after the late latch
+layout(set = 0, binding = 0) uniform Camera {
+    mat4 viewProjection;
+} camera;
+
+layout(push_constant) uniform DrawPushConstants {
+    mat4 transform;
+    uint materialIndex;
+    uint instanceOffset;
+    uint textureIndex;
+    uint samplerIndex;
+} draw;
+
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    gl_Position = camera.viewProjection * draw.transform * vec4(positions[gl_VertexIndex], 0.0, 1.0);
     fragColor = colors[gl_VertexIndex];
 }
\ No newline at end of file
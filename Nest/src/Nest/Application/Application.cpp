@@ -1,9 +1,11 @@
 #include <chrono>
 #include <cassert>
+#include <algorithm>
 
 #include "Nest/Application/Application.hpp"
 #include "Nest/Logger/Logger.hpp"
 #include "Nest/Window/Events.hpp"
+#include "Nest/Jobs/JobSystem.hpp"
 #include "Nest/Renderer/Vulkan/Vulkan.hpp"
 
 using namespace vk;
@@ -13,12 +15,15 @@ std::shared_ptr<spdlog::logger> Logger::s_logger = nullptr;
 Application::Application() : debugMode(true) {}
 
 Application::~Application() {
+    renderThread.stop();
     delete renderer;
     delete window;
+    JobSystem::shutdown();
 }
 
 void Application::init(const GlobalSettings &globalSettings) {
     debugMode = globalSettings.debugMode;
+    presentMode = globalSettings.presentMode;
     if (debugMode) {
         Logger::init();
         LOG_INFO("Application Start!");
@@ -36,6 +41,7 @@ void Application::init(const GlobalSettings &globalSettings) {
                                "   HOC VINCE"};
         LOG_INFO(message);
     }
+    JobSystem::init(globalSettings.workerThreads);
     window = new Window;
     window->init(globalSettings.appName.c_str(), globalSettings.resolutionX,
                  globalSettings.resolutionY, globalSettings.fullScreen);
@@ -48,11 +54,58 @@ void Application::init(const GlobalSettings &globalSettings) {
         }
         renderer = new Vulkan;
         renderer->init(globalSettings);
+        // Surface and device are created here, every later call happens on the render thread
+        if (globalSettings.renderThread) {
+            renderThread.start(renderer, std::clamp(globalSettings.renderPackets, 2, 3));
+        }
     } else if (globalSettings.api == GlobalSettings::OpenGL) {
         LOG_ERROR("OpenGL not supported now");
     }
 }
 
+static const char *toString(FrameBound bound) {
+    switch (bound) {
+        case FrameBound::Gpu:
+            return "GPU";
+        case FrameBound::Present:
+            return "present";
+        default:
+            return "CPU";
+    }
+}
+
+// Printed once a second next to the FPS
+static void logFrameStats(const FrameStats &stats) {
+    LOG_INFO("Draws: {}, pipelines: {}, pipeline binds: {} ({} saved), raster state changes: {}, "
+             "descriptor binds: {} ({} saved), reused recordings: {}, submits: {} ({} batches)", stats.draws,
+             stats.pipelines, stats.pipelineBinds, stats.pipelineBindsSaved, stats.rasterStateChanges,
+             stats.descriptorBinds, stats.descriptorBindsSaved, stats.commandBuffersReused, stats.submits,
+             stats.submitBatches);
+    const StallStats &stalls = stats.stalls;
+    LOG_INFO("Frame: {:.2f} ms, {} bound (GPU wait {:.2f} ms, acquire {:.2f} ms, present {:.2f} ms), "
+             "recent frames CPU/GPU/present bound: {}/{}/{}", stalls.frameMilliseconds, toString(stalls.bound),
+             stalls.gpuWaitMilliseconds, stalls.acquireMilliseconds, stalls.presentMilliseconds,
+             stalls.cpuBoundFrames, stalls.gpuBoundFrames, stalls.presentBoundFrames);
+    const LatencyStats &latency = stats.inputLatency;
+    if (latency.samples > 0) {
+        LOG_INFO("Input latency: {:.2f} ms, p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms over {} frames",
+                 latency.lastMilliseconds, latency.p50Milliseconds, latency.p90Milliseconds, latency.p99Milliseconds,
+                 latency.maxMilliseconds, latency.samples);
+    }
+    if (!stats.gpuZones.empty()) {
+        std::string zones;
+        for (const auto &zone: stats.gpuZones) {
+            zones += fmt::format("\n{}{}: {:.3f} ms", std::string(zone.depth * 2, ' '), zone.name, zone.milliseconds);
+        }
+        LOG_INFO("GPU frame: {:.3f} ms{}", stats.gpuFrameMilliseconds, zones);
+    }
+    for (const auto &pass: stats.passStatistics) {
+        LOG_INFO("Pass {}: {} vertices, {} vertex and {} fragment invocations, {} primitives, {} compute invocations",
+                 pass.name, pass.inputVertices, pass.vertexShaderInvocations, pass.fragmentShaderInvocations,
+                 pass.clippingPrimitives, pass.computeShaderInvocations);
+    }
+}
+
 uint64_t getMillis() {
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch());
@@ -93,6 +146,7 @@ void Application::loop() {
             fps = thisSecondFramesCount;
             if (debugMode) {
                 LOG_INFO("FPS: {}", fps);
+                logFrameStats(getFrameStats());
             }
             thisSecondFramesCount = 0;
             oneSecondTimeCount = 0;
@@ -101,6 +155,14 @@ void Application::loop() {
         double deltaTime = deltaTimeMillis / 1000.0;
         deltaTimeMillis = 0;
 
+        // Polled right before the update, so the frame sees the freshest input
+        Events::pollEvents();
+        // A minimized window has nothing to render to, sleep until it is restored instead of spinning.
+        // The restoring resize lands in this frame, so its packet carries the new size.
+        while (Events::getFramebufferSize() == glm::ivec2(0) && !window->shouldClose()) {
+            Events::waitEvents();
+        }
+
         if (Events::isJustKeyPressed(Key::TAB)) {
             Events::toggleCursorLock();
         }
@@ -108,11 +170,36 @@ void Application::loop() {
             close();
         }
 
-        renderer->render();
         currentLevel->update(deltaTime);
-        Events::pollEvents();
-        window->swapBuffers();
+
+        // The renderer only sees the window through packets, it may run on another thread
+        RenderPacket &packet = renderThread.isRunning() ? renderThread.beginPacket() : renderPacket;
+        glm::ivec2 framebufferSize = Events::getFramebufferSize();
+        packet.frame = ++frameCount;
+        packet.resized = Events::isJustFramebufferResized();
+        packet.framebufferWidth = framebufferSize.x;
+        packet.framebufferHeight = framebufferSize.y;
+        packet.presentMode = presentMode;
+        packet.viewProjection = glm::mat4(1.0f);
+        packet.latchViewProjection = nullptr;
+        packet.inputTime = Events::consumeInputTime();
+        packet.draws.clear();
+        packet.instances.clear();
+        currentLevel->fillRenderPacket(packet);
+        if (renderThread.isRunning()) {
+            renderThread.submitPacket();
+        } else {
+            renderer->render(packet);
+        }
+    }
+    renderThread.stop();
+}
+
+FrameStats Application::getFrameStats() {
+    if (!renderer) {
+        return FrameStats();
     }
+    return renderThread.isRunning() ? renderThread.getFrameStats() : renderer->getFrameStats();
 }
 
 void Application::close() {
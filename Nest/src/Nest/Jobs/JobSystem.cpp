@@ -0,0 +1,91 @@
+#include <atomic>
+#include <algorithm>
+
+#include "Nest/Jobs/JobSystem.hpp"
+
+std::vector<std::thread> JobSystem::workers;
+std::deque<std::function<void(uint32_t)>> JobSystem::jobs;
+std::mutex JobSystem::mutex;
+std::mutex JobSystem::dispatchMutex;
+std::condition_variable JobSystem::wakeUp;
+bool JobSystem::running = false;
+
+void JobSystem::init(uint32_t workerCount) {
+    if (running) {
+        return;
+    }
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+    running = true;
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(workerLoop, i);
+    }
+}
+
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wakeUp.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    workers.clear();
+    jobs.clear();
+}
+
+uint32_t JobSystem::getThreadCount() {
+    return static_cast<uint32_t>(workers.size()) + 1;
+}
+
+void JobSystem::parallelFor(uint32_t count,
+                            const std::function<void(uint32_t index, uint32_t threadIndex)> &job) {
+    std::lock_guard<std::mutex> dispatch(dispatchMutex);
+    std::atomic<uint32_t> remaining = count;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < count; ++i) {
+            jobs.emplace_back([&job, &remaining, i](uint32_t threadIndex) {
+                job(i, threadIndex);
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+    }
+    wakeUp.notify_all();
+
+    // The caller takes the last thread index
+    uint32_t callerIndex = getThreadCount() - 1;
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        std::function<void(uint32_t)> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!jobs.empty()) {
+                next = std::move(jobs.front());
+                jobs.pop_front();
+            }
+        }
+        if (next) {
+            next(callerIndex);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(uint32_t threadIndex) {
+    while (true) {
+        std::function<void(uint32_t)> next;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [] { return !running || !jobs.empty(); });
+            if (!running) {
+                return;
+            }
+            next = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        next(threadIndex);
+    }
+}
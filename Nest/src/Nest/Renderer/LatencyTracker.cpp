@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#include "Nest/Renderer/LatencyTracker.hpp"
+
+void LatencyTracker::submit(uint64_t frame, double inputTime) {
+    if (inputTime <= 0.0) {
+        return;
+    }
+    // Frames that are never seen, e.g. lost to a swapchain recreation, must not pile up
+    if (m_pending.size() >= windowSize) {
+        m_pending.pop_front();
+    }
+    m_pending.push_back({frame, inputTime});
+}
+
+void LatencyTracker::displayed(uint64_t frame, double time) {
+    bool added = false;
+    while (!m_pending.empty() && m_pending.front().frame <= frame) {
+        auto milliseconds = static_cast<float>((time - m_pending.front().inputTime) * 1000.0);
+        m_pending.pop_front();
+        if (m_samples.size() < windowSize) {
+            m_samples.push_back(milliseconds);
+        } else {
+            m_samples[m_nextSample] = milliseconds;
+        }
+        m_nextSample = (m_nextSample + 1) % windowSize;
+        m_stats.lastMilliseconds = milliseconds;
+        added = true;
+    }
+    if (added) {
+        updatePercentiles();
+    }
+}
+
+void LatencyTracker::updatePercentiles() {
+    m_sorted = m_samples;
+    std::sort(m_sorted.begin(), m_sorted.end());
+    auto percentile = [this](float share) {
+        auto index = static_cast<size_t>(share * static_cast<float>(m_sorted.size() - 1) + 0.5f);
+        return m_sorted[index];
+    };
+    m_stats.p50Milliseconds = percentile(0.5f);
+    m_stats.p90Milliseconds = percentile(0.9f);
+    m_stats.p99Milliseconds = percentile(0.99f);
+    m_stats.maxMilliseconds = m_sorted.back();
+    m_stats.samples = static_cast<uint32_t>(m_sorted.size());
+}
+
+const LatencyStats &LatencyTracker::getStats() const {
+    return m_stats;
+}
@@ -0,0 +1,75 @@
+#include "Nest/Renderer/RenderThread.hpp"
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+void RenderThread::start(Renderer *renderer, uint32_t packetCount) {
+    if (m_running) {
+        return;
+    }
+    m_renderer = renderer;
+    m_packets.assign(packetCount, RenderPacket());
+    m_writeIndex = 0;
+    m_readIndex = 0;
+    m_queuedCount = 0;
+    m_running = true;
+    m_thread = std::thread(&RenderThread::loop, this);
+}
+
+void RenderThread::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_packetQueued.notify_one();
+    m_thread.join();
+}
+
+bool RenderThread::isRunning() const {
+    return m_running;
+}
+
+RenderPacket &RenderThread::beginPacket() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_packetReleased.wait(lock, [this] { return m_queuedCount < m_packets.size(); });
+    return m_packets[m_writeIndex];
+}
+
+void RenderThread::submitPacket() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writeIndex = (m_writeIndex + 1) % m_packets.size();
+        ++m_queuedCount;
+    }
+    m_packetQueued.notify_one();
+}
+
+FrameStats RenderThread::getFrameStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frameStats;
+}
+
+void RenderThread::loop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_packetQueued.wait(lock, [this] { return !m_running || m_queuedCount > 0; });
+            if (m_queuedCount == 0) {
+                return;
+            }
+        }
+        // The game thread writes other packets meanwhile, this one stays untouched until it is released
+        m_renderer->render(m_packets[m_readIndex]);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_frameStats = m_renderer->getFrameStats();
+            m_readIndex = (m_readIndex + 1) % m_packets.size();
+            --m_queuedCount;
+        }
+        m_packetReleased.notify_one();
+    }
+}
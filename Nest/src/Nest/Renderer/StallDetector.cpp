@@ -0,0 +1,107 @@
+#include "Nest/Renderer/StallDetector.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+static float millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static const char *boundName(FrameBound bound) {
+    switch (bound) {
+        case FrameBound::Cpu:
+            return "CPU";
+        case FrameBound::Gpu:
+            return "GPU";
+        case FrameBound::Present:
+            return "present";
+    }
+    return "unknown";
+}
+
+StallDetector::Scope::Scope(StallDetector &detector, Point point)
+        : m_detector(detector), m_point(point), m_start(std::chrono::steady_clock::now()) {}
+
+StallDetector::Scope::~Scope() {
+    m_detector.addStall(m_point, millisecondsSince(m_start));
+}
+
+void StallDetector::init(bool debug) {
+    m_debug = debug;
+}
+
+void StallDetector::beginFrame() {
+    auto now = std::chrono::steady_clock::now();
+    if (!m_started) {
+        m_started = true;
+        m_frameStart = now;
+        m_current = {};
+        return;
+    }
+
+    m_stats.frameMilliseconds = std::chrono::duration<float, std::milli>(now - m_frameStart).count();
+    m_stats.gpuWaitMilliseconds = m_current[static_cast<size_t>(Point::GpuWait)];
+    m_stats.acquireMilliseconds = m_current[static_cast<size_t>(Point::Acquire)];
+    m_stats.presentMilliseconds = m_current[static_cast<size_t>(Point::Present)];
+    m_frameStart = now;
+    m_current = {};
+
+    // Acquire blocks when every image is queued for presentation, so it counts as present bound
+    float gpu = m_stats.gpuWaitMilliseconds;
+    float present = m_stats.acquireMilliseconds + m_stats.presentMilliseconds;
+    float cpu = m_stats.frameMilliseconds - gpu - present;
+    m_stats.bound = FrameBound::Cpu;
+    if (gpu > cpu && gpu >= present) {
+        m_stats.bound = FrameBound::Gpu;
+    } else if (present > cpu && present > gpu) {
+        m_stats.bound = FrameBound::Present;
+    }
+
+    // The oldest frame of a full window drops out
+    if (m_windowFrames == windowSize) {
+        --getBoundFrames(m_window[m_windowIndex]);
+    } else {
+        ++m_windowFrames;
+    }
+    m_window[m_windowIndex] = m_stats.bound;
+    m_windowIndex = (m_windowIndex + 1) % windowSize;
+    ++getBoundFrames(m_stats.bound);
+
+    if (m_windowFrames < windowSize) {
+        return;
+    }
+    auto threshold = static_cast<uint32_t>(dominantShare * windowSize);
+    for (FrameBound bound: {FrameBound::Cpu, FrameBound::Gpu, FrameBound::Present}) {
+        if (getBoundFrames(bound) < threshold) {
+            continue;
+        }
+        // Once per takeover instead of every frame
+        if (m_debug && (!m_warned || m_warnedBound != bound)) {
+            LOG_WARN("{} of the last {} frames were {} bound (GPU wait {:.2f} ms, acquire {:.2f} ms, present "
+                     "{:.2f} ms of {:.2f} ms)", getBoundFrames(bound), windowSize, boundName(bound),
+                     m_stats.gpuWaitMilliseconds, m_stats.acquireMilliseconds, m_stats.presentMilliseconds,
+                     m_stats.frameMilliseconds);
+        }
+        m_warned = true;
+        m_warnedBound = bound;
+        return;
+    }
+    m_warned = false;
+}
+
+uint32_t &StallDetector::getBoundFrames(FrameBound bound) {
+    switch (bound) {
+        case FrameBound::Gpu:
+            return m_stats.gpuBoundFrames;
+        case FrameBound::Present:
+            return m_stats.presentBoundFrames;
+        default:
+            return m_stats.cpuBoundFrames;
+    }
+}
+
+void StallDetector::addStall(Point point, float milliseconds) {
+    m_current[static_cast<size_t>(point)] += milliseconds;
+}
+
+const StallStats &StallDetector::getStats() const {
+    return m_stats;
+}
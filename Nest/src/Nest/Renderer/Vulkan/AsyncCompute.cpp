@@ -0,0 +1,187 @@
+#include "Nest/Renderer/Vulkan/AsyncCompute.hpp"
+#include "Nest/Renderer/Vulkan/Commands.hpp"
+#include "Nest/Renderer/Vulkan/Sync.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+void AsyncCompute::init(const Device &device, const QueueFamilyIndices &indices, const Queue &computeQueue,
+                        const Queue &graphicsQueue, uint32_t framesInFlight, bool synchronization2,
+                        const DispatchLoaderDynamic &dld, bool debug) {
+    m_device = device;
+    m_graphicsQueue = graphicsQueue;
+    m_graphicsFamily = indices.graphicsFamily.value();
+    m_async = static_cast<bool>(computeQueue);
+    m_computeQueue = m_async ? computeQueue : graphicsQueue;
+    m_computeFamily = m_async ? indices.computeFamily.value() : m_graphicsFamily;
+    m_synchronization2 = synchronization2;
+    m_dld = &dld;
+    m_debug = debug;
+
+    m_frames.resize(framesInFlight);
+    for (auto &frame: m_frames) {
+        frame.pool = makeCommandPool(device, m_computeFamily, CommandPoolCreateFlagBits::eTransient, debug);
+        CommandBufferAllocateInfo allocInfo;
+        allocInfo.commandPool = frame.pool;
+        allocInfo.level = CommandBufferLevel::ePrimary;
+        allocInfo.commandBufferCount = 1;
+        try {
+            frame.commandBuffer = device.allocateCommandBuffers(allocInfo)[0];
+        } catch (const SystemError &err) {
+            if (debug) {
+                LOG_ERROR("Failed to allocate compute command buffer\n{}", err.what());
+            }
+        }
+        if (m_async) {
+            frame.finished = makeSemaphore(device, debug);
+        }
+    }
+    if (debug) {
+        LOG_INFO(m_async ? "Async compute queue enabled" : "No async compute queue, compute runs on graphics");
+    }
+}
+
+void AsyncCompute::destroy() {
+    for (const auto &frame: m_frames) {
+        m_device.destroySemaphore(frame.finished);
+        m_device.destroyCommandPool(frame.pool);
+    }
+    m_frames.clear();
+}
+
+bool AsyncCompute::isAsync() const {
+    return m_async;
+}
+
+std::vector<uint32_t> AsyncCompute::getQueueFamilies() const {
+    if (m_computeFamily == m_graphicsFamily) {
+        return {m_graphicsFamily};
+    }
+    return {m_graphicsFamily, m_computeFamily};
+}
+
+void AsyncCompute::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    m_recording = false;
+    m_device.resetCommandPool(m_frames[frameIndex].pool);
+    m_bufferReleases.clear();
+    m_imageReleases.clear();
+    m_bufferAcquires.clear();
+    m_imageAcquires.clear();
+}
+
+CommandBuffer AsyncCompute::getCommandBuffer() {
+    CommandBuffer commandBuffer = m_frames[m_frameIndex].commandBuffer;
+    if (!m_recording) {
+        CommandBufferBeginInfo beginInfo;
+        beginInfo.flags = CommandBufferUsageFlagBits::eOneTimeSubmit;
+        commandBuffer.begin(beginInfo);
+        m_recording = true;
+    }
+    return commandBuffer;
+}
+
+void AsyncCompute::barrier(PipelineStageFlags2 srcStages, AccessFlags2 srcAccess, PipelineStageFlags2 dstStages,
+                           AccessFlags2 dstAccess) {
+    MemoryBarrier2 memoryBarrier(srcStages, srcAccess, dstStages, dstAccess);
+    CommandBuffer commandBuffer = getCommandBuffer();
+    if (m_synchronization2) {
+        DependencyInfo dependencyInfo;
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &memoryBarrier;
+        commandBuffer.pipelineBarrier2(dependencyInfo, *m_dld);
+        return;
+    }
+    MemoryBarrier legacy(toLegacyAccess(srcAccess), toLegacyAccess(dstAccess));
+    commandBuffer.pipelineBarrier(toLegacyStages(srcStages, PipelineStageFlagBits::eTopOfPipe),
+                                  toLegacyStages(dstStages, PipelineStageFlagBits::eBottomOfPipe),
+                                  DependencyFlags(), legacy, nullptr, nullptr);
+}
+
+void AsyncCompute::transferBuffer(const Buffer &buffer, PipelineStageFlags2 srcStages, AccessFlags2 srcAccess,
+                                  PipelineStageFlags2 dstStages, AccessFlags2 dstAccess) {
+    BufferMemoryBarrier2 barrier;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    if (!m_async) {
+        // Same queue, the submission order makes an ordinary barrier enough
+        barrier.srcStageMask = srcStages;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstStageMask = dstStages;
+        barrier.dstAccessMask = dstAccess;
+        m_bufferAcquires.emplace_back(barrier);
+        return;
+    }
+    barrier.srcQueueFamilyIndex = m_computeFamily;
+    barrier.dstQueueFamilyIndex = m_graphicsFamily;
+    // The release makes the writes available, the semaphore orders it before the acquire
+    BufferMemoryBarrier2 release = barrier;
+    release.srcStageMask = srcStages;
+    release.srcAccessMask = srcAccess;
+    m_bufferReleases.emplace_back(release);
+    BufferMemoryBarrier2 acquire = barrier;
+    acquire.dstStageMask = dstStages;
+    acquire.dstAccessMask = dstAccess;
+    m_bufferAcquires.emplace_back(acquire);
+}
+
+void AsyncCompute::transferImage(const Image &image, const ImageSubresourceRange &range, ImageLayout layout,
+                                 PipelineStageFlags2 srcStages, AccessFlags2 srcAccess, PipelineStageFlags2 dstStages,
+                                 AccessFlags2 dstAccess) {
+    ImageMemoryBarrier2 barrier;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+    barrier.oldLayout = layout;
+    barrier.newLayout = layout;
+    if (!m_async) {
+        barrier.srcStageMask = srcStages;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstStageMask = dstStages;
+        barrier.dstAccessMask = dstAccess;
+        m_imageAcquires.emplace_back(barrier);
+        return;
+    }
+    barrier.srcQueueFamilyIndex = m_computeFamily;
+    barrier.dstQueueFamilyIndex = m_graphicsFamily;
+    ImageMemoryBarrier2 release = barrier;
+    release.srcStageMask = srcStages;
+    release.srcAccessMask = srcAccess;
+    m_imageReleases.emplace_back(release);
+    ImageMemoryBarrier2 acquire = barrier;
+    acquire.dstStageMask = dstStages;
+    acquire.dstAccessMask = dstAccess;
+    m_imageAcquires.emplace_back(acquire);
+}
+
+void AsyncCompute::submit(SubmitBatcher &batcher, PipelineStageFlags2 waitStages) {
+    if (!m_recording) {
+        return;
+    }
+    FrameData &frame = m_frames[m_frameIndex];
+    if (!m_bufferReleases.empty() || !m_imageReleases.empty()) {
+        recordBarriers(frame.commandBuffer, m_imageReleases, m_bufferReleases, m_synchronization2, *m_dld);
+    }
+    try {
+        frame.commandBuffer.end();
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to record compute command buffer\n{}", err.what());
+        }
+    }
+    m_recording = false;
+
+    batcher.submit(m_computeQueue, frame.commandBuffer);
+    if (!m_async) {
+        return;
+    }
+    // Binary semaphore waits have to be submitted after their signal, so the compute queue goes out right away
+    batcher.signal(m_computeQueue, frame.finished);
+    batcher.flush(m_computeQueue);
+    batcher.wait(m_graphicsQueue, frame.finished, waitStages);
+}
+
+void AsyncCompute::acquire(const CommandBuffer &commandBuffer) {
+    if (m_bufferAcquires.empty() && m_imageAcquires.empty()) {
+        return;
+    }
+    recordBarriers(commandBuffer, m_imageAcquires, m_bufferAcquires, m_synchronization2, *m_dld);
+}
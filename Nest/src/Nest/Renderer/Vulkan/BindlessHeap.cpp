@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <array>
+
+#include "Nest/Renderer/Vulkan/BindlessHeap.hpp"
+#include "Nest/Logger/Logger.hpp"
+#include "Nest/Settings/SettingsLog.hpp"
+
+// Upper bounds of the arrays, clamped to the update-after-bind limits of the device
+static constexpr uint32_t maxSampledImages = 16384;
+static constexpr uint32_t maxSamplers = 256;
+static constexpr uint32_t maxStorageBuffers = 4096;
+
+uint32_t BindlessHeap::Slots::allocate() {
+    if (!freed.empty()) {
+        uint32_t index = freed.back();
+        freed.pop_back();
+        return index;
+    }
+    if (next == capacity) {
+        return invalidIndex;
+    }
+    return next++;
+}
+
+void BindlessHeap::Slots::release(uint32_t index) {
+    if (index < next) {
+        freed.emplace_back(index);
+    }
+}
+
+void BindlessHeap::init(const Device &device, const PhysicalDevice &physicalDevice, bool debug) {
+    m_device = device;
+    m_debug = debug;
+
+    PhysicalDeviceDescriptorIndexingProperties indexingProperties;
+    PhysicalDeviceProperties2 properties;
+    properties.pNext = &indexingProperties;
+    physicalDevice.getProperties2(&properties);
+
+    m_sampledImages.capacity = std::min({maxSampledImages,
+                                         indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                         indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    m_samplers.capacity = std::min({maxSamplers,
+                                    indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                    indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers});
+    m_storageBuffers.capacity = std::min({maxStorageBuffers,
+                                          indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                          indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+
+    std::array<DescriptorSetLayoutBinding, 3> bindings;
+    bindings[0] = {sampledImageBinding, DescriptorType::eSampledImage, m_sampledImages.capacity,
+                   ShaderStageFlagBits::eAll};
+    bindings[1] = {samplerBinding, DescriptorType::eSampler, m_samplers.capacity, ShaderStageFlagBits::eAll};
+    bindings[2] = {storageBufferBinding, DescriptorType::eStorageBuffer, m_storageBuffers.capacity,
+                   ShaderStageFlagBits::eAll};
+
+    // Unused slots never have to be written and slots can be written while the set is bound
+    DescriptorBindingFlags bindingFlag = DescriptorBindingFlagBits::ePartiallyBound |
+                                         DescriptorBindingFlagBits::eUpdateAfterBind;
+    std::array<DescriptorBindingFlags, 3> bindingFlags = {bindingFlag, bindingFlag, bindingFlag};
+    DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo;
+    bindingFlagsInfo.bindingCount = bindingFlags.size();
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    DescriptorSetLayoutCreateInfo layoutInfo;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+
+    std::array<DescriptorPoolSize, 3> poolSizes = {
+            DescriptorPoolSize(DescriptorType::eSampledImage, m_sampledImages.capacity),
+            DescriptorPoolSize(DescriptorType::eSampler, m_samplers.capacity),
+            DescriptorPoolSize(DescriptorType::eStorageBuffer, m_storageBuffers.capacity)
+    };
+    DescriptorPoolCreateInfo poolInfo;
+    poolInfo.flags = DescriptorPoolCreateFlagBits::eUpdateAfterBind;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    try {
+        m_layout = m_device.createDescriptorSetLayout(layoutInfo);
+        m_pool = m_device.createDescriptorPool(poolInfo);
+
+        DescriptorSetAllocateInfo allocInfo;
+        allocInfo.descriptorPool = m_pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_layout;
+        m_set = m_device.allocateDescriptorSets(allocInfo)[0];
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to create bindless descriptor heap\n{}", err.what());
+        }
+        return;
+    }
+
+    if (VK_PRINT_DEVICE_INFO) {
+        LOG_INFO("Bindless heap: {} sampled images, {} samplers, {} storage buffers",
+                 m_sampledImages.capacity, m_samplers.capacity, m_storageBuffers.capacity);
+    }
+}
+
+void BindlessHeap::destroy() {
+    // Destroying the pool frees the set
+    m_device.destroyDescriptorPool(m_pool);
+    m_device.destroyDescriptorSetLayout(m_layout);
+    m_pool = nullptr;
+    m_layout = nullptr;
+    m_set = nullptr;
+}
+
+uint32_t BindlessHeap::addSampledImage(const ImageView &imageView, ImageLayout layout) {
+    uint32_t index = m_sampledImages.allocate();
+    if (index == invalidIndex) {
+        if (m_debug) {
+            LOG_ERROR("Bindless heap is out of sampled image slots");
+        }
+        return index;
+    }
+    DescriptorImageInfo imageInfo(nullptr, imageView, layout);
+    WriteDescriptorSet write(m_set, sampledImageBinding, index, 1, DescriptorType::eSampledImage, &imageInfo);
+    m_device.updateDescriptorSets(1, &write, 0, nullptr);
+    return index;
+}
+
+uint32_t BindlessHeap::addSampler(const Sampler &sampler) {
+    uint32_t index = m_samplers.allocate();
+    if (index == invalidIndex) {
+        if (m_debug) {
+            LOG_ERROR("Bindless heap is out of sampler slots");
+        }
+        return index;
+    }
+    DescriptorImageInfo imageInfo(sampler, nullptr, ImageLayout::eUndefined);
+    WriteDescriptorSet write(m_set, samplerBinding, index, 1, DescriptorType::eSampler, &imageInfo);
+    m_device.updateDescriptorSets(1, &write, 0, nullptr);
+    return index;
+}
+
+uint32_t BindlessHeap::addStorageBuffer(const Buffer &buffer, DeviceSize offset, DeviceSize range) {
+    uint32_t index = m_storageBuffers.allocate();
+    if (index == invalidIndex) {
+        if (m_debug) {
+            LOG_ERROR("Bindless heap is out of storage buffer slots");
+        }
+        return index;
+    }
+    DescriptorBufferInfo bufferInfo(buffer, offset, range);
+    WriteDescriptorSet write(m_set, storageBufferBinding, index, 1, DescriptorType::eStorageBuffer, nullptr,
+                             &bufferInfo);
+    m_device.updateDescriptorSets(1, &write, 0, nullptr);
+    return index;
+}
+
+void BindlessHeap::removeSampledImage(uint32_t index) {
+    m_sampledImages.release(index);
+}
+
+void BindlessHeap::removeSampler(uint32_t index) {
+    m_samplers.release(index);
+}
+
+void BindlessHeap::removeStorageBuffer(uint32_t index) {
+    m_storageBuffers.release(index);
+}
+
+void BindlessHeap::bind(const CommandBuffer &commandBuffer, PipelineBindPoint bindPoint,
+                        const PipelineLayout &layout, uint32_t setIndex) const {
+    commandBuffer.bindDescriptorSets(bindPoint, layout, setIndex, 1, &m_set, 0, nullptr);
+}
+
+DescriptorSetLayout BindlessHeap::getLayout() const {
+    return m_layout;
+}
@@ -0,0 +1,124 @@
+#include <cstring>
+
+#include "Nest/Renderer/Vulkan/CameraBuffers.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+void CameraBuffers::init(const Device &device, const PhysicalDevice &physicalDevice, DeletionQueue &deletionQueue,
+                         bool debug) {
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_deletionQueue = &deletionQueue;
+    m_debug = debug;
+
+    DescriptorSetLayoutBinding binding(0, DescriptorType::eUniformBuffer, 1, ShaderStageFlagBits::eVertex);
+    DescriptorSetLayoutCreateInfo layoutInfo;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    try {
+        m_layout = m_device.createDescriptorSetLayout(layoutInfo);
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to create camera descriptor set layout\n{}", err.what());
+        }
+    }
+}
+
+void CameraBuffers::destroy() {
+    for (auto &entry: m_entries) {
+        destroyBuffer(m_device, entry.buffer);
+    }
+    m_entries.clear();
+    // Destroying the pool frees the sets
+    m_device.destroyDescriptorPool(m_pool);
+    m_device.destroyDescriptorSetLayout(m_layout);
+    m_pool = nullptr;
+    m_layout = nullptr;
+}
+
+DescriptorSetLayout CameraBuffers::getLayout() const {
+    return m_layout;
+}
+
+void CameraBuffers::release(uint64_t frame) {
+    if (m_entries.empty() && !m_pool) {
+        return;
+    }
+    std::vector<AllocatedBuffer> buffers;
+    for (const auto &entry: m_entries) {
+        buffers.emplace_back(entry.buffer);
+    }
+    m_deletionQueue->push(frame, [device = m_device, pool = m_pool, buffers]() mutable {
+        for (auto &buffer: buffers) {
+            destroyBuffer(device, buffer);
+        }
+        device.destroyDescriptorPool(pool);
+    });
+    m_entries.clear();
+    m_pool = nullptr;
+}
+
+void CameraBuffers::resize(uint32_t imageCount, uint64_t frame) {
+    release(frame);
+    if (!m_layout || imageCount == 0) {
+        return;
+    }
+
+    DescriptorPoolSize poolSize(DescriptorType::eUniformBuffer, imageCount);
+    DescriptorPoolCreateInfo poolInfo;
+    poolInfo.maxSets = imageCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    std::vector<DescriptorSet> sets;
+    try {
+        m_pool = m_device.createDescriptorPool(poolInfo);
+        std::vector<DescriptorSetLayout> layouts(imageCount, m_layout);
+        DescriptorSetAllocateInfo allocInfo;
+        allocInfo.descriptorPool = m_pool;
+        allocInfo.descriptorSetCount = imageCount;
+        allocInfo.pSetLayouts = layouts.data();
+        sets = m_device.allocateDescriptorSets(allocInfo);
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to allocate camera descriptor sets\n{}", err.what());
+        }
+        return;
+    }
+
+    m_entries.resize(imageCount);
+    for (uint32_t i = 0; i < imageCount; ++i) {
+        Entry &entry = m_entries[i];
+        entry.set = sets[i];
+        entry.buffer = makeBuffer(m_device, m_physicalDevice, sizeof(CameraUniforms),
+                                  BufferUsageFlagBits::eUniformBuffer,
+                                  MemoryPropertyFlagBits::eHostVisible | MemoryPropertyFlagBits::eHostCoherent,
+                                  m_debug);
+        if (!entry.buffer.buffer) {
+            // Binding a set that was never written is invalid, the draws go without a camera instead
+            entry.set = nullptr;
+            continue;
+        }
+        write(i, glm::mat4(1.0f));
+
+        DescriptorBufferInfo bufferInfo(entry.buffer.buffer, 0, sizeof(CameraUniforms));
+        WriteDescriptorSet descriptorWrite(entry.set, 0, 0, 1, DescriptorType::eUniformBuffer, nullptr, &bufferInfo);
+        m_device.updateDescriptorSets(1, &descriptorWrite, 0, nullptr);
+    }
+}
+
+void CameraBuffers::write(uint32_t imageIndex, const glm::mat4 &viewProjection) {
+    if (imageIndex >= m_entries.size() || !m_entries[imageIndex].buffer.mapped) {
+        return;
+    }
+    CameraUniforms uniforms;
+    uniforms.viewProjection = viewProjection;
+    std::memcpy(m_entries[imageIndex].buffer.mapped, &uniforms, sizeof(uniforms));
+}
+
+void CameraBuffers::bind(const CommandBuffer &commandBuffer, const PipelineLayout &layout, uint32_t imageIndex,
+                         uint32_t setIndex) const {
+    if (imageIndex >= m_entries.size() || !m_entries[imageIndex].set) {
+        return;
+    }
+    commandBuffer.bindDescriptorSets(PipelineBindPoint::eGraphics, layout, setIndex, m_entries[imageIndex].set,
+                                     nullptr);
+}
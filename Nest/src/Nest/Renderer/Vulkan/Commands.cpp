@@ -22,6 +22,46 @@ makeCommandPool(const Device &device, const PhysicalDevice &physicalDevice, cons
     }
 }
 
+CommandPool
+makeCommandPool(const Device &device, uint32_t queueFamilyIndex, CommandPoolCreateFlags flags, bool debug) {
+    CommandPoolCreateInfo poolInfo;
+    poolInfo.flags = flags;
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+    try {
+        return device.createCommandPool(poolInfo);
+    } catch (const SystemError &err) {
+        if (debug) {
+            LOG_ERROR("Failed to create Command Pool\n{}", err.what());
+        }
+        return nullptr;
+    }
+}
+
+CommandBuffer acquireSecondaryCommandBuffer(const Device &device, ThreadCommandPool &threadPool) {
+    if (threadPool.usedSecondaryCommandBuffers == threadPool.secondaryCommandBuffers.size()) {
+        CommandBufferAllocateInfo allocInfo;
+        allocInfo.commandPool = threadPool.pool;
+        allocInfo.level = CommandBufferLevel::eSecondary;
+        allocInfo.commandBufferCount = 1;
+        try {
+            threadPool.secondaryCommandBuffers.emplace_back(device.allocateCommandBuffers(allocInfo)[0]);
+        } catch (const SystemError &err) {
+            if (VK_PRINT_COMMANDBUFFER_INFO) {
+                LOG_ERROR("Failed to allocate secondary command buffer\n{}", err.what());
+            }
+            return nullptr;
+        }
+    }
+    return threadPool.secondaryCommandBuffers[threadPool.usedSecondaryCommandBuffers++];
+}
+
+void resetThreadCommandPool(const Device &device, ThreadCommandPool &threadPool) {
+    // Resetting the pool recycles every command buffer at once, they stay allocated for the next frame
+    device.resetCommandPool(threadPool.pool);
+    threadPool.usedSecondaryCommandBuffers = 0;
+}
+
 CommandBuffer makeCommandBuffer(const CommandBufferInputChunk &inputChunk) {
     CommandBufferAllocateInfo allocInfo;
     allocInfo.commandPool = inputChunk.commandPool;
@@ -52,7 +92,7 @@ void makeFrameCommandBuffers(const CommandBufferInputChunk &inputChunk) {
     allocInfo.commandBufferCount = 1;
 
     bool debug = VK_PRINT_COMMANDBUFFER_INFO;
-    // make a command buffer for each frame
+    // make a command buffer for each frame in flight
     for (int i = 0; i < inputChunk.frames.size(); ++i) {
         try {
             inputChunk.frames[i].commandBuffer = inputChunk.device.allocateCommandBuffers(allocInfo)[0];
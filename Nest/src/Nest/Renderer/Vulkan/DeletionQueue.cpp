@@ -0,0 +1,28 @@
+#include "Nest/Renderer/Vulkan/DeletionQueue.hpp"
+
+void DeletionQueue::push(uint64_t value, std::function<void()> deleter) {
+    m_entries.push_back({value, std::move(deleter)});
+}
+
+void DeletionQueue::flush(uint64_t completedValue) {
+    std::vector<Entry> pending;
+    for (auto &entry: m_entries) {
+        if (entry.value <= completedValue) {
+            entry.deleter();
+        } else {
+            pending.emplace_back(std::move(entry));
+        }
+    }
+    m_entries = std::move(pending);
+}
+
+void DeletionQueue::flushAll() {
+    for (auto &entry: m_entries) {
+        entry.deleter();
+    }
+    m_entries.clear();
+}
+
+size_t DeletionQueue::size() const {
+    return m_entries.size();
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <array>
+
+#include "Nest/Renderer/Vulkan/DescriptorAllocator.hpp"
+#include "Nest/Renderer/Vulkan/Hash.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+static constexpr uint32_t initialSetsPerPool = 64;
+static constexpr uint32_t maxSetsPerPool = 4096;
+
+// Descriptors per set reserved for each type, a pool holds setsPerPool times these
+static constexpr std::array<std::pair<DescriptorType, uint32_t>, 6> poolRatios = {{
+        {DescriptorType::eUniformBuffer, 2},
+        {DescriptorType::eStorageBuffer, 2},
+        {DescriptorType::eCombinedImageSampler, 4},
+        {DescriptorType::eSampledImage, 2},
+        {DescriptorType::eSampler, 1},
+        {DescriptorType::eStorageImage, 1}
+}};
+
+static size_t hashWrites(const DescriptorSetLayout &layout, const std::vector<DescriptorWrite> &writes) {
+    size_t hash = 0;
+    hashCombine(hash, handleValue(layout));
+    for (const auto &write: writes) {
+        hashCombine(hash, write.binding);
+        hashCombine(hash, static_cast<uint32_t>(write.type));
+        hashCombine(hash, handleValue(write.image.sampler));
+        hashCombine(hash, handleValue(write.image.imageView));
+        hashCombine(hash, static_cast<uint32_t>(write.image.imageLayout));
+        hashCombine(hash, handleValue(write.buffer.buffer));
+        hashCombine(hash, write.buffer.offset);
+        hashCombine(hash, write.buffer.range);
+    }
+    return hash;
+}
+
+void DescriptorAllocator::init(const Device &device, uint32_t framesInFlight, bool debug) {
+    m_device = device;
+    m_debug = debug;
+    m_framePools.resize(framesInFlight);
+    for (auto &list: m_framePools) {
+        list.setsPerPool = initialSetsPerPool;
+    }
+    m_immutablePools.setsPerPool = initialSetsPerPool;
+}
+
+void DescriptorAllocator::destroy() {
+    for (auto &list: m_framePools) {
+        for (const auto &pool: list.pools) {
+            m_device.destroyDescriptorPool(pool);
+        }
+    }
+    for (const auto &pool: m_immutablePools.pools) {
+        m_device.destroyDescriptorPool(pool);
+    }
+    m_framePools.clear();
+    m_immutablePools = PoolList();
+    m_immutableSets.clear();
+}
+
+void DescriptorAllocator::resetFrame(uint32_t frameIndex) {
+    PoolList &list = m_framePools[frameIndex];
+    for (const auto &pool: list.pools) {
+        m_device.resetDescriptorPool(pool);
+    }
+    list.current = 0;
+}
+
+DescriptorSet DescriptorAllocator::allocate(uint32_t frameIndex, const DescriptorSetLayout &layout) {
+    return allocateFrom(m_framePools[frameIndex], layout);
+}
+
+DescriptorSet DescriptorAllocator::allocate(uint32_t frameIndex, const DescriptorSetLayout &layout,
+                                            const std::vector<DescriptorWrite> &writes) {
+    DescriptorSet set = allocate(frameIndex, layout);
+    if (set) {
+        write(set, writes);
+    }
+    return set;
+}
+
+DescriptorSet DescriptorAllocator::getImmutableSet(const DescriptorSetLayout &layout,
+                                                   const std::vector<DescriptorWrite> &writes) {
+    size_t key = hashWrites(layout, writes);
+    auto cached = m_immutableSets.find(key);
+    if (cached != m_immutableSets.end()) {
+        return cached->second;
+    }
+    DescriptorSet set = allocateFrom(m_immutablePools, layout);
+    if (set) {
+        write(set, writes);
+        m_immutableSets[key] = set;
+    }
+    return set;
+}
+
+size_t DescriptorAllocator::getPoolCount() const {
+    size_t count = m_immutablePools.pools.size();
+    for (const auto &list: m_framePools) {
+        count += list.pools.size();
+    }
+    return count;
+}
+
+DescriptorSet DescriptorAllocator::allocateFrom(PoolList &list, const DescriptorSetLayout &layout) {
+    DescriptorSetAllocateInfo allocInfo;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    while (true) {
+        if (list.current == list.pools.size()) {
+            DescriptorPool pool = makePool(list.setsPerPool);
+            if (!pool) {
+                return nullptr;
+            }
+            list.pools.emplace_back(pool);
+            // Frames that needed one more pool will likely need it again, so the next one is larger
+            list.setsPerPool = std::min(list.setsPerPool * 2, maxSetsPerPool);
+        }
+        allocInfo.descriptorPool = list.pools[list.current];
+        try {
+            return m_device.allocateDescriptorSets(allocInfo)[0];
+        } catch (const OutOfPoolMemoryError &) {
+            ++list.current;
+        } catch (const FragmentedPoolError &) {
+            ++list.current;
+        } catch (const SystemError &err) {
+            if (m_debug) {
+                LOG_ERROR("Failed to allocate descriptor set\n{}", err.what());
+            }
+            return nullptr;
+        }
+    }
+}
+
+DescriptorPool DescriptorAllocator::makePool(uint32_t maxSets) {
+    std::vector<DescriptorPoolSize> poolSizes;
+    for (const auto &[type, ratio]: poolRatios) {
+        poolSizes.emplace_back(type, ratio * maxSets);
+    }
+
+    DescriptorPoolCreateInfo poolInfo;
+    poolInfo.flags = DescriptorPoolCreateFlags();
+    poolInfo.maxSets = maxSets;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    try {
+        return m_device.createDescriptorPool(poolInfo);
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to create descriptor pool\n{}", err.what());
+        }
+        return nullptr;
+    }
+}
+
+void DescriptorAllocator::write(const DescriptorSet &set, const std::vector<DescriptorWrite> &writes) {
+    std::vector<WriteDescriptorSet> descriptorWrites;
+    descriptorWrites.reserve(writes.size());
+    for (const auto &write: writes) {
+        WriteDescriptorSet descriptorWrite;
+        descriptorWrite.dstSet = set;
+        descriptorWrite.dstBinding = write.binding;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.descriptorType = write.type;
+        bool isBuffer = write.type == DescriptorType::eUniformBuffer ||
+                        write.type == DescriptorType::eStorageBuffer ||
+                        write.type == DescriptorType::eUniformBufferDynamic ||
+                        write.type == DescriptorType::eStorageBufferDynamic;
+        if (isBuffer) {
+            descriptorWrite.pBufferInfo = &write.buffer;
+        } else {
+            descriptorWrite.pImageInfo = &write.image;
+        }
+        descriptorWrites.emplace_back(descriptorWrite);
+    }
+    m_device.updateDescriptorSets(descriptorWrites, nullptr);
+}
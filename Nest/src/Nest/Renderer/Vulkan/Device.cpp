@@ -1,6 +1,9 @@
 #include <vector>
+#include <algorithm>
 #include <set>
 #include <string>
+#include <cstring>
+#include <sstream>
 #include "Nest/Renderer/Vulkan/Device.hpp"
 #include "Nest/Renderer/Vulkan/Logging.hpp"
 #include "Nest/Renderer/Vulkan/QueueFamilies.hpp"
@@ -88,27 +91,259 @@ bool isSuitable(const PhysicalDevice &device) {
     }
 }
 
+static bool hasExtension(const std::vector<ExtensionProperties> &extensions, const char *name) {
+    for (const auto &extension: extensions) {
+        if (strcmp(extension.extensionName, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Links a structure at the front of a pNext chain
+template<typename Head, typename Next>
+static void chainStruct(Head &head, Next &next) {
+    next.pNext = head.pNext;
+    head.pNext = &next;
+}
+
+DeviceCapabilities queryDeviceCapabilities(const PhysicalDevice &physicalDevice, uint32_t instanceApiVersion) {
+    DeviceCapabilities capabilities;
+    // A 1.3 driver behind a 1.1 instance only offers 1.1 core functionality
+    capabilities.apiVersion = std::min(physicalDevice.getProperties().apiVersion, instanceApiVersion);
+    std::vector<ExtensionProperties> extensions = physicalDevice.enumerateDeviceExtensionProperties();
+
+    // Only chain the structures of extensions the device actually exposes
+    PhysicalDeviceFeatures2 features;
+    PhysicalDeviceProperties2 properties;
+
+    PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures;
+    PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT pipelineLibraryProperties;
+    bool pipelineLibrarySupported = hasExtension(extensions, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+                                    hasExtension(extensions, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    if (pipelineLibrarySupported) {
+        chainStruct(features, pipelineLibraryFeatures);
+        chainStruct(properties, pipelineLibraryProperties);
+    }
+
+    PhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicStateFeatures;
+    bool dynamicStateSupported = hasExtension(extensions, VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+    if (dynamicStateSupported) {
+        chainStruct(features, dynamicStateFeatures);
+    }
+    PhysicalDeviceExtendedDynamicState2FeaturesEXT dynamicState2Features;
+    bool dynamicState2Supported = hasExtension(extensions, VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+    if (dynamicState2Supported) {
+        chainStruct(features, dynamicState2Features);
+    }
+    PhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features;
+    bool dynamicState3Supported = hasExtension(extensions, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    if (dynamicState3Supported) {
+        chainStruct(features, dynamicState3Features);
+    }
+
+    PhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenanceFeatures;
+    bool swapchainMaintenanceSupported = hasExtension(extensions, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+    if (swapchainMaintenanceSupported) {
+        chainStruct(features, swapchainMaintenanceFeatures);
+    }
+
+    PhysicalDeviceTimelineSemaphoreFeatures timelineFeatures;
+    bool timelineCore = capabilities.apiVersion >= VK_API_VERSION_1_2;
+    bool timelineSupported = timelineCore || hasExtension(extensions, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    if (timelineSupported) {
+        chainStruct(features, timelineFeatures);
+    }
+    PhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures;
+    bool dynamicRenderingCore = capabilities.apiVersion >= VK_API_VERSION_1_3;
+    bool dynamicRenderingSupported =
+            dynamicRenderingCore || hasExtension(extensions, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    if (dynamicRenderingSupported) {
+        chainStruct(features, dynamicRenderingFeatures);
+    }
+    PhysicalDeviceDescriptorIndexingFeatures indexingFeatures;
+    bool indexingCore = capabilities.apiVersion >= VK_API_VERSION_1_2;
+    bool indexingSupported = indexingCore || hasExtension(extensions, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    if (indexingSupported) {
+        chainStruct(features, indexingFeatures);
+    }
+    PhysicalDeviceSynchronization2Features synchronization2Features;
+    bool synchronization2Core = capabilities.apiVersion >= VK_API_VERSION_1_3;
+    bool synchronization2Supported =
+            synchronization2Core || hasExtension(extensions, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    if (synchronization2Supported) {
+        chainStruct(features, synchronization2Features);
+    }
+
+    PhysicalDevicePresentIdFeaturesKHR presentIdFeatures;
+    PhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures;
+    bool presentWaitSupported = hasExtension(extensions, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+                                hasExtension(extensions, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    if (presentWaitSupported) {
+        chainStruct(features, presentIdFeatures);
+        chainStruct(features, presentWaitFeatures);
+    }
+
+    physicalDevice.getFeatures2(&features);
+    physicalDevice.getProperties2(&properties);
+
+    capabilities.graphicsPipelineLibrary = pipelineLibrarySupported && pipelineLibraryFeatures.graphicsPipelineLibrary;
+    capabilities.graphicsPipelineLibraryFastLinking =
+            capabilities.graphicsPipelineLibrary && pipelineLibraryProperties.graphicsPipelineLibraryFastLinking;
+    capabilities.extendedDynamicState = dynamicStateSupported && dynamicStateFeatures.extendedDynamicState;
+    capabilities.extendedDynamicState2 = dynamicState2Supported && dynamicState2Features.extendedDynamicState2;
+    capabilities.extendedDynamicState3PolygonMode =
+            dynamicState3Supported && dynamicState3Features.extendedDynamicState3PolygonMode;
+    capabilities.extendedDynamicState3ColorBlendEnable =
+            dynamicState3Supported && dynamicState3Features.extendedDynamicState3ColorBlendEnable;
+    capabilities.swapchainMaintenance1 =
+            swapchainMaintenanceSupported && swapchainMaintenanceFeatures.swapchainMaintenance1;
+    capabilities.timelineSemaphore = timelineSupported && timelineFeatures.timelineSemaphore;
+    capabilities.timelineSemaphoreExtension = capabilities.timelineSemaphore && !timelineCore;
+    capabilities.dynamicRendering = dynamicRenderingSupported && dynamicRenderingFeatures.dynamicRendering;
+    capabilities.dynamicRenderingExtension = capabilities.dynamicRendering && !dynamicRenderingCore;
+    capabilities.descriptorIndexing = indexingSupported && indexingFeatures.runtimeDescriptorArray &&
+                                      indexingFeatures.descriptorBindingPartiallyBound &&
+                                      indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+                                      indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind &&
+                                      indexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+                                      indexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
+    capabilities.descriptorIndexingExtension = capabilities.descriptorIndexing && !indexingCore;
+    capabilities.synchronization2 = synchronization2Supported && synchronization2Features.synchronization2;
+    capabilities.synchronization2Extension = capabilities.synchronization2 && !synchronization2Core;
+    capabilities.multiDrawIndirect = features.features.multiDrawIndirect && features.features.drawIndirectFirstInstance;
+    capabilities.drawIndirectCount = hasExtension(extensions, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    capabilities.pipelineStatisticsQuery =
+            features.features.pipelineStatisticsQuery && features.features.inheritedQueries;
+    capabilities.presentWait = presentWaitSupported && presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+
+    if (VK_PRINT_DEVICE_INFO) {
+        std::ostringstream message;
+        message << "Device capabilities:";
+        message << "\n\tAPI version: " << VK_API_VERSION_MAJOR(capabilities.apiVersion) << "."
+                << VK_API_VERSION_MINOR(capabilities.apiVersion);
+        message << "\n\tGraphics pipeline library: " << capabilities.graphicsPipelineLibrary
+                << " (fast linking: " << capabilities.graphicsPipelineLibraryFastLinking << ")";
+        message << "\n\tExtended dynamic state: " << capabilities.extendedDynamicState
+                << ", 2: " << capabilities.extendedDynamicState2
+                << ", 3 polygon mode: " << capabilities.extendedDynamicState3PolygonMode
+                << ", 3 color blend enable: " << capabilities.extendedDynamicState3ColorBlendEnable;
+        message << "\n\tSwapchain maintenance 1: " << capabilities.swapchainMaintenance1;
+        message << "\n\tTimeline semaphore: " << capabilities.timelineSemaphore;
+        message << "\n\tDynamic rendering: " << capabilities.dynamicRendering;
+        message << "\n\tDescriptor indexing: " << capabilities.descriptorIndexing;
+        message << "\n\tSynchronization 2: " << capabilities.synchronization2;
+        message << "\n\tMulti draw indirect: " << capabilities.multiDrawIndirect
+                << " (draw indirect count: " << capabilities.drawIndirectCount << ")";
+        message << "\n\tPipeline statistics query: " << capabilities.pipelineStatisticsQuery;
+        message << "\n\tPresent wait: " << capabilities.presentWait;
+        LOG_INFO("{}", message.str());
+    }
+    return capabilities;
+}
 
-Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKHR &surface, bool debug) {
+Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKHR &surface,
+                           const DeviceCapabilities &capabilities, bool debug) {
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice, surface);
-    std::vector<uint32_t> uniqueIndices;
-    uniqueIndices.emplace_back(indices.graphicsFamily.value());
-    if (indices.graphicsFamily.value() != indices.presentFamily.value()) {
-        uniqueIndices.emplace_back(indices.presentFamily.value());
+    // Number of queues taken from each family
+    std::vector<std::pair<uint32_t, uint32_t>> familyQueues;
+    auto addQueue = [&familyQueues](uint32_t family, uint32_t queueIndex) {
+        for (auto &[queueFamily, count]: familyQueues) {
+            if (queueFamily == family) {
+                count = std::max(count, queueIndex + 1);
+                return;
+            }
+        }
+        familyQueues.emplace_back(family, queueIndex + 1);
+    };
+    addQueue(indices.graphicsFamily.value(), 0);
+    addQueue(indices.presentFamily.value(), 0);
+    if (indices.computeFamily.has_value()) {
+        addQueue(indices.computeFamily.value(), indices.computeQueueIndex);
     }
-    float queuePriority = 1.0f;
+    if (indices.transferFamily.has_value()) {
+        addQueue(indices.transferFamily.value(), 0);
+    }
+    float queuePriorities[] = {1.0f, 1.0f};
 
     std::vector<DeviceQueueCreateInfo> queueCreateInfo;
-    for (auto &queueFamilyIndex: uniqueIndices) {
+    for (const auto &[queueFamilyIndex, queueCount]: familyQueues) {
         DeviceQueueCreateInfo createInfo;
         createInfo.flags = DeviceQueueCreateFlags();
-        createInfo.queueCount = 1;
+        createInfo.queueCount = queueCount;
         createInfo.queueFamilyIndex = queueFamilyIndex;
-        createInfo.pQueuePriorities = &queuePriority;
+        createInfo.pQueuePriorities = queuePriorities;
         queueCreateInfo.emplace_back(createInfo);
     }
 
-    PhysicalDeviceFeatures deviceFeatures;
+    PhysicalDeviceFeatures2 deviceFeatures;
+    deviceFeatures.features.multiDrawIndirect = capabilities.multiDrawIndirect;
+    deviceFeatures.features.drawIndirectFirstInstance = capabilities.multiDrawIndirect;
+    deviceFeatures.features.pipelineStatisticsQuery = capabilities.pipelineStatisticsQuery;
+    deviceFeatures.features.inheritedQueries = capabilities.pipelineStatisticsQuery;
+
+    PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures;
+    if (capabilities.graphicsPipelineLibrary) {
+        pipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+        chainStruct(deviceFeatures, pipelineLibraryFeatures);
+    }
+    PhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicStateFeatures;
+    if (capabilities.extendedDynamicState) {
+        dynamicStateFeatures.extendedDynamicState = VK_TRUE;
+        chainStruct(deviceFeatures, dynamicStateFeatures);
+    }
+    PhysicalDeviceExtendedDynamicState2FeaturesEXT dynamicState2Features;
+    if (capabilities.extendedDynamicState2) {
+        dynamicState2Features.extendedDynamicState2 = VK_TRUE;
+        chainStruct(deviceFeatures, dynamicState2Features);
+    }
+    PhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features;
+    bool dynamicState3 =
+            capabilities.extendedDynamicState3PolygonMode || capabilities.extendedDynamicState3ColorBlendEnable;
+    if (dynamicState3) {
+        dynamicState3Features.extendedDynamicState3PolygonMode = capabilities.extendedDynamicState3PolygonMode;
+        dynamicState3Features.extendedDynamicState3ColorBlendEnable =
+                capabilities.extendedDynamicState3ColorBlendEnable;
+        chainStruct(deviceFeatures, dynamicState3Features);
+    }
+    PhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenanceFeatures;
+    if (capabilities.swapchainMaintenance1) {
+        swapchainMaintenanceFeatures.swapchainMaintenance1 = VK_TRUE;
+        chainStruct(deviceFeatures, swapchainMaintenanceFeatures);
+    }
+    PhysicalDeviceTimelineSemaphoreFeatures timelineFeatures;
+    if (capabilities.timelineSemaphore) {
+        timelineFeatures.timelineSemaphore = VK_TRUE;
+        chainStruct(deviceFeatures, timelineFeatures);
+    }
+    PhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures;
+    if (capabilities.dynamicRendering) {
+        dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+        chainStruct(deviceFeatures, dynamicRenderingFeatures);
+    }
+    PhysicalDeviceDescriptorIndexingFeatures indexingFeatures;
+    if (capabilities.descriptorIndexing) {
+        indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        indexingFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+        chainStruct(deviceFeatures, indexingFeatures);
+    }
+    PhysicalDeviceSynchronization2Features synchronization2Features;
+    if (capabilities.synchronization2) {
+        synchronization2Features.synchronization2 = VK_TRUE;
+        chainStruct(deviceFeatures, synchronization2Features);
+    }
+    PhysicalDevicePresentIdFeaturesKHR presentIdFeatures;
+    PhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures;
+    if (capabilities.presentWait) {
+        presentIdFeatures.presentId = VK_TRUE;
+        presentWaitFeatures.presentWait = VK_TRUE;
+        chainStruct(deviceFeatures, presentIdFeatures);
+        chainStruct(deviceFeatures, presentWaitFeatures);
+    }
 
     std::vector<const char *> enabledLayers;
     if (debug) {
@@ -120,6 +355,47 @@ Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKH
 #ifdef PLATFORM_MACOS
     extensions.emplace_back(VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME);
 #endif
+    if (capabilities.graphicsPipelineLibrary) {
+        extensions.emplace_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        extensions.emplace_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    }
+    if (capabilities.extendedDynamicState) {
+        extensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+    }
+    if (capabilities.extendedDynamicState2) {
+        extensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+    }
+    if (dynamicState3) {
+        extensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    }
+    if (capabilities.swapchainMaintenance1) {
+        extensions.emplace_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+    }
+    if (capabilities.timelineSemaphoreExtension) {
+        extensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    }
+    if (capabilities.dynamicRenderingExtension) {
+        // VK_KHR_dynamic_rendering depends on VK_KHR_depth_stencil_resolve and VK_KHR_create_renderpass2,
+        // which are core since Vulkan 1.2
+        if (capabilities.apiVersion < VK_API_VERSION_1_2) {
+            extensions.emplace_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+            extensions.emplace_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+        }
+        extensions.emplace_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+    if (capabilities.descriptorIndexingExtension) {
+        extensions.emplace_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+    if (capabilities.presentWait) {
+        extensions.emplace_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        extensions.emplace_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
+    if (capabilities.synchronization2Extension) {
+        extensions.emplace_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+    }
+    if (capabilities.drawIndirectCount) {
+        extensions.emplace_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
 
     DeviceCreateInfo deviceInfo;
     deviceInfo.flags = DeviceCreateFlags();
@@ -129,7 +405,8 @@ Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKH
     deviceInfo.ppEnabledLayerNames = enabledLayers.data();
     deviceInfo.enabledExtensionCount = extensions.size();
     deviceInfo.ppEnabledExtensionNames = extensions.data();
-    deviceInfo.pEnabledFeatures = &deviceFeatures;
+    // Features are passed through the pNext chain, so pEnabledFeatures stays null
+    deviceInfo.pNext = &deviceFeatures;
 
     try {
         Device device = physicalDevice.createDevice(deviceInfo);
@@ -145,13 +422,23 @@ Device createLogicalDevice(const PhysicalDevice &physicalDevice, const SurfaceKH
     }
 }
 
-std::array<Queue, 2>
+std::array<Queue, 4>
 getQueues(const PhysicalDevice &physicalDevice, const Device &device, const SurfaceKHR &surface,
           bool debug) {
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice, surface);
 
+    Queue computeQueue;
+    if (indices.computeFamily.has_value()) {
+        computeQueue = device.getQueue(indices.computeFamily.value(), indices.computeQueueIndex);
+    }
+    Queue transferQueue;
+    if (indices.transferFamily.has_value()) {
+        transferQueue = device.getQueue(indices.transferFamily.value(), 0);
+    }
     return {
             device.getQueue(indices.graphicsFamily.value(), 0),
-            device.getQueue(indices.presentFamily.value(), 0)
+            device.getQueue(indices.presentFamily.value(), 0),
+            computeQueue,
+            transferQueue
     };
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <algorithm>
+
+#include "Nest/Renderer/Vulkan/GpuProfiler.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+static constexpr uint32_t invalidZone = ~0u;
+
+GpuProfiler *GpuProfiler::s_active = nullptr;
+
+void GpuProfiler::init(const Device &device, const PhysicalDevice &physicalDevice, uint32_t queueFamilyIndex,
+                       uint32_t framesInFlight, bool debugLabels, const DispatchLoaderDynamic &dld, bool debug) {
+    m_device = device;
+    m_dld = &dld;
+    m_debug = debug;
+    m_labels = debugLabels;
+    m_frames.resize(framesInFlight);
+    s_active = this;
+
+    uint32_t validBits = physicalDevice.getQueueFamilyProperties()[queueFamilyIndex].timestampValidBits;
+    m_supported = validBits > 0;
+    if (!m_supported) {
+        if (m_debug) {
+            LOG_WARN("Queue family {} has no timestamps, GPU zones only emit labels", queueFamilyIndex);
+        }
+        return;
+    }
+    m_timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    // Nanoseconds per timestamp tick
+    m_timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+
+    QueryPoolCreateInfo createInfo;
+    createInfo.queryType = QueryType::eTimestamp;
+    createInfo.queryCount = maxZonesPerFrame * 2;
+    for (auto &frame: m_frames) {
+        try {
+            frame.pool = m_device.createQueryPool(createInfo);
+        } catch (const SystemError &err) {
+            m_supported = false;
+            if (m_debug) {
+                LOG_ERROR("Failed to create timestamp query pool\n{}", err.what());
+            }
+        }
+    }
+}
+
+void GpuProfiler::destroy() {
+    for (auto &frame: m_frames) {
+        if (frame.pool) {
+            m_device.destroyQueryPool(frame.pool);
+        }
+    }
+    m_frames.clear();
+    if (s_active == this) {
+        s_active = nullptr;
+    }
+}
+
+bool GpuProfiler::isSupported() const {
+    return m_supported;
+}
+
+void GpuProfiler::beginFrame(uint32_t frameIndex, const CommandBuffer &commandBuffer) {
+    std::lock_guard lock(m_mutex);
+    m_frameIndex = frameIndex;
+    FrameData &frame = m_frames[frameIndex];
+    readResults(frame);
+    frame.zones.clear();
+    frame.depth = 0;
+    if (m_supported) {
+        commandBuffer.resetQueryPool(frame.pool, 0, maxZonesPerFrame * 2);
+    }
+}
+
+void GpuProfiler::readResults(FrameData &frame) {
+    if (!m_supported || frame.zones.empty()) {
+        return;
+    }
+    auto zoneCount = static_cast<uint32_t>(std::min<size_t>(frame.zones.size(), maxZonesPerFrame));
+    std::vector<uint64_t> timestamps(zoneCount * 2);
+    // Without the wait flag an incomplete frame reports eNotReady instead of blocking
+    Result result = m_device.getQueryPoolResults(frame.pool, 0, zoneCount * 2,
+                                                 timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                                                 sizeof(uint64_t), QueryResultFlagBits::e64);
+    if (result != Result::eSuccess) {
+        return;
+    }
+
+    m_results.clear();
+    uint64_t first = ~0ull;
+    uint64_t last = 0;
+    for (uint32_t i = 0; i < zoneCount; ++i) {
+        uint64_t begin = timestamps[i * 2] & m_timestampMask;
+        uint64_t end = timestamps[i * 2 + 1] & m_timestampMask;
+        first = std::min(first, begin);
+        last = std::max(last, end);
+        GpuZoneStats &zone = m_results.emplace_back();
+        zone.name = frame.zones[i].name;
+        zone.depth = frame.zones[i].depth;
+        zone.milliseconds = end > begin ? static_cast<float>(end - begin) * m_timestampPeriod * 1e-6f : 0.0f;
+    }
+    m_frameMilliseconds = last > first ? static_cast<float>(last - first) * m_timestampPeriod * 1e-6f : 0.0f;
+}
+
+uint32_t GpuProfiler::beginZone(const CommandBuffer &commandBuffer, const char *name) {
+    if (m_labels) {
+        DebugUtilsLabelEXT label;
+        label.pLabelName = name;
+        commandBuffer.beginDebugUtilsLabelEXT(label, *m_dld);
+    }
+    std::lock_guard lock(m_mutex);
+    FrameData &frame = m_frames[m_frameIndex];
+    uint32_t depth = frame.depth++;
+    if (!m_supported || frame.zones.size() >= maxZonesPerFrame) {
+        return invalidZone;
+    }
+    auto zone = static_cast<uint32_t>(frame.zones.size());
+    frame.zones.push_back({name, depth});
+    commandBuffer.writeTimestamp(PipelineStageFlagBits::eTopOfPipe, frame.pool, zone * 2);
+    return zone;
+}
+
+void GpuProfiler::endZone(const CommandBuffer &commandBuffer, uint32_t zone) {
+    {
+        std::lock_guard lock(m_mutex);
+        FrameData &frame = m_frames[m_frameIndex];
+        --frame.depth;
+        if (zone != invalidZone) {
+            commandBuffer.writeTimestamp(PipelineStageFlagBits::eBottomOfPipe, frame.pool, zone * 2 + 1);
+        }
+    }
+    if (m_labels) {
+        commandBuffer.endDebugUtilsLabelEXT(*m_dld);
+    }
+}
+
+const std::vector<GpuZoneStats> &GpuProfiler::getZones() const {
+    return m_results;
+}
+
+float GpuProfiler::getFrameMilliseconds() const {
+    return m_frameMilliseconds;
+}
+
+GpuProfiler *GpuProfiler::getActive() {
+    return s_active;
+}
+
+GpuZone::GpuZone(const CommandBuffer &commandBuffer, const char *name)
+        : m_profiler(GpuProfiler::getActive()), m_commandBuffer(commandBuffer) {
+    if (m_profiler) {
+        m_zone = m_profiler->beginZone(commandBuffer, name);
+    }
+}
+
+GpuZone::~GpuZone() {
+    if (m_profiler) {
+        m_profiler->endZone(m_commandBuffer, m_zone);
+    }
+}
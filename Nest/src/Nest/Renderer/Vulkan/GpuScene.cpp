@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "Nest/Renderer/Vulkan/GpuScene.hpp"
+#include "Nest/Renderer/Vulkan/Pipeline.hpp"
+#include "Nest/Renderer/Vulkan/PushConstants.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+static constexpr uint32_t cullGroupSize = 64;
+static constexpr DeviceSize minBufferSize = 256;
+
+void GpuScene::init(const Device &device, const PhysicalDevice &physicalDevice,
+                    const DeviceCapabilities &capabilities, DescriptorAllocator &descriptorAllocator,
+                    AsyncCompute &asyncCompute, UploadQueue &uploadQueue, uint32_t framesInFlight,
+                    const std::string &shaderDirectory, const DispatchLoaderDynamic &dld, bool debug) {
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_descriptorAllocator = &descriptorAllocator;
+    m_asyncCompute = &asyncCompute;
+    m_uploadQueue = &uploadQueue;
+    m_dld = &dld;
+    m_debug = debug;
+    m_drawIndirectCount = capabilities.drawIndirectCount;
+    m_maxDrawCount = physicalDevice.getProperties().limits.maxDrawIndirectCount;
+    setViewProjection(glm::mat4(1.0f));
+
+    std::string cullShader = shaderDirectory + "cull.spv";
+    std::string vertexShader = shaderDirectory + "gpuDriven.spv";
+    if (!capabilities.multiDrawIndirect) {
+        return;
+    }
+    // The shaders are compiled by Scripts/BuildShaders.sh, older checkouts may not have them yet
+    if (!std::filesystem::exists(cullShader) || !std::filesystem::exists(vertexShader)) {
+        if (debug) {
+            LOG_WARN("GPU-driven rendering disabled, compile the shaders with Scripts/BuildShaders.sh");
+        }
+        return;
+    }
+
+    std::array<DescriptorSetLayoutBinding, 4> bindings;
+    bindings[0] = {0, DescriptorType::eStorageBuffer, 1, ShaderStageFlagBits::eCompute | ShaderStageFlagBits::eVertex};
+    bindings[1] = {1, DescriptorType::eStorageBuffer, 1, ShaderStageFlagBits::eCompute};
+    bindings[2] = {2, DescriptorType::eStorageBuffer, 1, ShaderStageFlagBits::eCompute};
+    bindings[3] = {3, DescriptorType::eStorageBuffer, 1, ShaderStageFlagBits::eCompute};
+    DescriptorSetLayoutCreateInfo layoutInfo;
+    layoutInfo.bindingCount = bindings.size();
+    layoutInfo.pBindings = bindings.data();
+    try {
+        m_layout = device.createDescriptorSetLayout(layoutInfo);
+    } catch (const SystemError &err) {
+        if (debug) {
+            LOG_ERROR("Failed to create GPU scene descriptor set layout\n{}", err.what());
+        }
+        return;
+    }
+
+    std::vector<PushConstantRange> pushConstantRanges = {
+            makePushConstantRange<CullPushConstants>(ShaderStageFlagBits::eCompute)
+    };
+    m_cullLayout = makePipelineLayout(device, {m_layout}, pushConstantRanges, debug);
+    m_cullPipeline = makeComputePipeline(device, m_cullLayout, cullShader, debug);
+    m_frames.resize(framesInFlight);
+    m_supported = static_cast<bool>(m_cullPipeline);
+}
+
+void GpuScene::destroy() {
+    for (auto &frame: m_frames) {
+        destroyBuffer(m_device, frame.instances);
+        destroyBuffer(m_device, frame.meshes);
+        destroyBuffer(m_device, frame.indices);
+        destroyBuffer(m_device, frame.drawCommands);
+        destroyBuffer(m_device, frame.drawCount);
+    }
+    m_frames.clear();
+    m_device.destroyPipeline(m_cullPipeline);
+    m_device.destroyPipelineLayout(m_cullLayout);
+    m_device.destroyDescriptorSetLayout(m_layout);
+    m_supported = false;
+}
+
+bool GpuScene::isSupported() const {
+    return m_supported;
+}
+
+DescriptorSetLayout GpuScene::getLayout() const {
+    return m_layout;
+}
+
+uint32_t GpuScene::addMesh(const std::vector<uint32_t> &indices) {
+    GpuMesh mesh;
+    mesh.indexCount = indices.size();
+    mesh.firstIndex = m_indices.size();
+    m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+    m_meshes.emplace_back(mesh);
+    ++m_geometryVersion;
+    return m_meshes.size() - 1;
+}
+
+uint32_t GpuScene::addInstance(const GpuInstance &instance) {
+    m_instances.emplace_back(instance);
+    ++m_instanceVersion;
+    return m_instances.size() - 1;
+}
+
+void GpuScene::setInstance(uint32_t index, const GpuInstance &instance) {
+    m_instances[index] = instance;
+    ++m_instanceVersion;
+}
+
+void GpuScene::setInstances(const std::vector<GpuInstance> &instances) {
+    m_instances = instances;
+    ++m_instanceVersion;
+}
+
+uint32_t GpuScene::getInstanceCount() const {
+    return m_instances.size();
+}
+
+void GpuScene::setViewProjection(const glm::mat4 &viewProjection) {
+    m_drawConstants.viewProjection = viewProjection;
+    // Gribb-Hartmann plane extraction for a 0..1 depth range, glm stores columns so rows are gathered by hand
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; ++i) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+    m_frustumPlanes = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2],
+                       rows[3] - rows[2]};
+    for (auto &plane: m_frustumPlanes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+}
+
+const GpuDrawPushConstants &GpuScene::getDrawPushConstants() const {
+    return m_drawConstants;
+}
+
+void GpuScene::reserve(AllocatedBuffer &buffer, DeviceSize size, BufferUsageFlags usage,
+                       MemoryPropertyFlags properties, const std::vector<uint32_t> &queueFamilies) {
+    if (buffer.buffer && buffer.size >= size) {
+        return;
+    }
+    // The frame owning the buffer has completed, so it can go right away
+    DeviceSize capacity = std::max({size, buffer.size * 2, minBufferSize});
+    destroyBuffer(m_device, buffer);
+    buffer = makeBuffer(m_device, m_physicalDevice, capacity, usage, properties, m_debug, queueFamilies);
+}
+
+void GpuScene::uploadGeometry(FrameData &frame) {
+    MemoryPropertyFlags hostVisible = MemoryPropertyFlagBits::eHostVisible | MemoryPropertyFlagBits::eHostCoherent;
+    DeviceSize meshesSize = m_meshes.size() * sizeof(GpuMesh);
+    DeviceSize indicesSize = m_indices.size() * sizeof(uint32_t);
+
+    // Read by culling on both queues
+    reserve(frame.meshes, meshesSize, BufferUsageFlagBits::eStorageBuffer, hostVisible,
+            m_asyncCompute->getQueueFamilies());
+    // Geometry rarely changes and is read every frame, so it lives in device local memory
+    reserve(frame.indices, indicesSize, BufferUsageFlagBits::eIndexBuffer | BufferUsageFlagBits::eTransferDst,
+            MemoryPropertyFlagBits::eDeviceLocal);
+    if (frame.meshes.mapped && frame.indices.buffer) {
+        std::memcpy(frame.meshes.mapped, m_meshes.data(), meshesSize);
+        m_uploadQueue->uploadBuffer(frame.indices.buffer, 0, m_indices.data(), indicesSize,
+                                    PipelineStageFlagBits2::eIndexInput, AccessFlagBits2::eIndexRead);
+        frame.geometryVersion = m_geometryVersion;
+    }
+}
+
+void GpuScene::uploadInstances(FrameData &frame) {
+    MemoryPropertyFlags hostVisible = MemoryPropertyFlagBits::eHostVisible | MemoryPropertyFlagBits::eHostCoherent;
+    DeviceSize instancesSize = m_instances.size() * sizeof(GpuInstance);
+
+    // Read by culling and drawing on both queues, the draw commands change owner every frame instead
+    reserve(frame.instances, instancesSize, BufferUsageFlagBits::eStorageBuffer, hostVisible,
+            m_asyncCompute->getQueueFamilies());
+    reserve(frame.drawCommands, m_instances.size() * sizeof(DrawIndexedIndirectCommand),
+            BufferUsageFlagBits::eStorageBuffer | BufferUsageFlagBits::eIndirectBuffer,
+            MemoryPropertyFlagBits::eDeviceLocal);
+    reserve(frame.drawCount, sizeof(uint32_t), BufferUsageFlagBits::eStorageBuffer |
+                                               BufferUsageFlagBits::eIndirectBuffer |
+                                               BufferUsageFlagBits::eTransferDst,
+            MemoryPropertyFlagBits::eDeviceLocal);
+
+    if (frame.instances.mapped) {
+        std::memcpy(frame.instances.mapped, m_instances.data(), instancesSize);
+        frame.instanceVersion = m_instanceVersion;
+    }
+}
+
+void GpuScene::addCullPasses(RenderGraph &graph, uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    FrameData &frame = m_frames[frameIndex];
+    if (frame.geometryVersion != m_geometryVersion) {
+        uploadGeometry(frame);
+    }
+    if (frame.instanceVersion != m_instanceVersion) {
+        uploadInstances(frame);
+    }
+
+    std::vector<DescriptorWrite> writes(4);
+    const AllocatedBuffer *buffers[] = {&frame.instances, &frame.meshes, &frame.drawCommands, &frame.drawCount};
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+        writes[i].binding = i;
+        writes[i].type = DescriptorType::eStorageBuffer;
+        writes[i].buffer = DescriptorBufferInfo(buffers[i]->buffer, 0, VK_WHOLE_SIZE);
+    }
+    frame.set = m_descriptorAllocator->allocate(frameIndex, m_layout, writes);
+
+    graph.importBuffer("GpuInstances", frame.instances.buffer, {frame.instances.size});
+    graph.importBuffer("GpuMeshes", frame.meshes.buffer, {frame.meshes.size});
+    graph.importBuffer("GpuDrawCommands", frame.drawCommands.buffer, {frame.drawCommands.size});
+    graph.importBuffer("GpuDrawCount", frame.drawCount.buffer, {frame.drawCount.size});
+
+    if (m_asyncCompute->isAsync()) {
+        recordAsyncCull(frame);
+        return;
+    }
+
+    if (m_drawIndirectCount) {
+        graph.addPass("ResetDrawCount", [](RenderGraphBuilder &builder) {
+            builder.write("GpuDrawCount", RenderGraphAccess::TransferWrite);
+        }, [&frame](const CommandBuffer &commandBuffer) {
+            commandBuffer.fillBuffer(frame.drawCount.buffer, 0, sizeof(uint32_t), 0);
+        });
+    }
+
+    graph.addPass("Cull", [this](RenderGraphBuilder &builder) {
+        builder.read("GpuInstances", RenderGraphAccess::StorageRead);
+        builder.read("GpuMeshes", RenderGraphAccess::StorageRead);
+        builder.write("GpuDrawCommands", RenderGraphAccess::StorageWrite);
+        if (m_drawIndirectCount) {
+            builder.write("GpuDrawCount", RenderGraphAccess::StorageWrite);
+        }
+    }, [this, &frame](const CommandBuffer &commandBuffer) {
+        recordCull(commandBuffer, frame);
+    });
+}
+
+void GpuScene::recordCull(const CommandBuffer &commandBuffer, const FrameData &frame) const {
+    CullPushConstants constants;
+    std::copy(m_frustumPlanes.begin(), m_frustumPlanes.end(), constants.frustumPlanes);
+    constants.instanceCount = m_instances.size();
+    constants.compact = m_drawIndirectCount;
+
+    commandBuffer.bindPipeline(PipelineBindPoint::eCompute, m_cullPipeline);
+    commandBuffer.bindDescriptorSets(PipelineBindPoint::eCompute, m_cullLayout, 0, frame.set, nullptr);
+    pushConstants(commandBuffer, m_cullLayout, ShaderStageFlagBits::eCompute, constants);
+    commandBuffer.dispatch((constants.instanceCount + cullGroupSize - 1) / cullGroupSize, 1, 1);
+}
+
+void GpuScene::recordAsyncCull(FrameData &frame) {
+    // The previous contents are overwritten, so the buffers are taken over from graphics without an acquire
+    CommandBuffer commandBuffer = m_asyncCompute->getCommandBuffer();
+    if (m_drawIndirectCount) {
+        commandBuffer.fillBuffer(frame.drawCount.buffer, 0, sizeof(uint32_t), 0);
+        m_asyncCompute->barrier(PipelineStageFlagBits2::eTransfer, AccessFlagBits2::eTransferWrite,
+                                PipelineStageFlagBits2::eComputeShader,
+                                AccessFlagBits2::eShaderStorageRead | AccessFlagBits2::eShaderStorageWrite);
+    }
+    recordCull(commandBuffer, frame);
+
+    m_asyncCompute->transferBuffer(frame.drawCommands.buffer, PipelineStageFlagBits2::eComputeShader,
+                                   AccessFlagBits2::eShaderStorageWrite, PipelineStageFlagBits2::eDrawIndirect,
+                                   AccessFlagBits2::eIndirectCommandRead);
+    if (m_drawIndirectCount) {
+        m_asyncCompute->transferBuffer(frame.drawCount.buffer, PipelineStageFlagBits2::eComputeShader,
+                                       AccessFlagBits2::eShaderStorageWrite, PipelineStageFlagBits2::eDrawIndirect,
+                                       AccessFlagBits2::eIndirectCommandRead);
+    }
+}
+
+void GpuScene::declareDrawReads(RenderGraphBuilder &builder) const {
+    builder.read("GpuInstances", RenderGraphAccess::StorageRead);
+    builder.read("GpuDrawCommands", RenderGraphAccess::IndirectRead);
+    if (m_drawIndirectCount) {
+        builder.read("GpuDrawCount", RenderGraphAccess::IndirectRead);
+    }
+}
+
+void GpuScene::draw(const CommandBuffer &commandBuffer, const PipelineLayout &layout) const {
+    const FrameData &frame = m_frames[m_frameIndex];
+    commandBuffer.bindDescriptorSets(PipelineBindPoint::eGraphics, layout, 0, frame.set, nullptr);
+    commandBuffer.bindIndexBuffer(frame.indices.buffer, 0, IndexType::eUint32);
+
+    // Instances beyond the device limit are not drawn
+    uint32_t maxDrawCount = std::min<uint32_t>(m_instances.size(), m_maxDrawCount);
+    if (m_drawIndirectCount) {
+        commandBuffer.drawIndexedIndirectCount(frame.drawCommands.buffer, 0, frame.drawCount.buffer, 0,
+                                               maxDrawCount, sizeof(DrawIndexedIndirectCommand), *m_dld);
+    } else {
+        commandBuffer.drawIndexedIndirect(frame.drawCommands.buffer, 0, maxDrawCount,
+                                          sizeof(DrawIndexedIndirectCommand));
+    }
+}
@@ -78,20 +78,24 @@ bool supported(const std::vector<const char *> &needExtensions, const std::vecto
     return true;
 }
 
+uint32_t getInstanceApiVersion() {
+    uint32_t version;
+    vkEnumerateInstanceVersion(&version);
+    // patch = 0
+    return version & ~(0xFFFU);
+}
+
 Instance makeInstanceVulkan(const char *appName) {
     bool debugMode = VK_PRINT_INSTANCE_INFO;
     if (debugMode) {
         LOG_INFO("Make instance...");
     }
-    uint32_t version;
-    vkEnumerateInstanceVersion(&version);
+    uint32_t version = getInstanceApiVersion();
     if (debugMode) {
         LOG_INFO("System can support Vulkan version: {}.{}.{}.{}",
                  VK_API_VERSION_VARIANT(version), VK_API_VERSION_MAJOR(version), VK_API_VERSION_MINOR(version),
                  VK_API_VERSION_PATCH(version));
     }
-    // patch = 0
-    version &= ~(0xFFFU);
 
     ApplicationInfo appInfo;
     appInfo.pApplicationName = appName;
@@ -112,6 +116,13 @@ Instance makeInstanceVulkan(const char *appName) {
     }
     extensions.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
 
+    // optional, needed by VK_EXT_swapchain_maintenance1 present fences
+    std::vector<const char *> surfaceMaintenance = {VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME,
+                                                    VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME};
+    if (supported(surfaceMaintenance, {})) {
+        extensions.insert(extensions.end(), surfaceMaintenance.begin(), surfaceMaintenance.end());
+    }
+
     if (VK_PRINT_SUPPORT_INFO) {
         std::ostringstream message;
         message << "Extension to be requested:\n";
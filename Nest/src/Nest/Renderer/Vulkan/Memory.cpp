@@ -0,0 +1,55 @@
+#include "Nest/Renderer/Vulkan/Memory.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+uint32_t findMemoryType(const PhysicalDevice &physicalDevice, uint32_t typeBits, MemoryPropertyFlags properties) {
+    PhysicalDeviceMemoryProperties memoryProperties = physicalDevice.getMemoryProperties();
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+        bool allowed = typeBits & (1u << i);
+        if (allowed && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+AllocatedBuffer makeBuffer(const Device &device, const PhysicalDevice &physicalDevice, DeviceSize size,
+                           BufferUsageFlags usage, MemoryPropertyFlags properties, bool debug,
+                           const std::vector<uint32_t> &queueFamilies) {
+    AllocatedBuffer allocated;
+    BufferCreateInfo bufferInfo;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = SharingMode::eExclusive;
+    if (queueFamilies.size() > 1) {
+        bufferInfo.sharingMode = SharingMode::eConcurrent;
+        bufferInfo.queueFamilyIndexCount = queueFamilies.size();
+        bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+    }
+    try {
+        allocated.buffer = device.createBuffer(bufferInfo);
+
+        MemoryRequirements requirements = device.getBufferMemoryRequirements(allocated.buffer);
+        MemoryAllocateInfo allocInfo;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, requirements.memoryTypeBits, properties);
+        allocated.memory = device.allocateMemory(allocInfo);
+        device.bindBufferMemory(allocated.buffer, allocated.memory, 0);
+
+        if (properties & MemoryPropertyFlagBits::eHostVisible) {
+            allocated.mapped = device.mapMemory(allocated.memory, 0, VK_WHOLE_SIZE);
+        }
+        allocated.size = size;
+    } catch (const SystemError &err) {
+        if (debug) {
+            LOG_ERROR("Failed to create buffer of {} bytes\n{}", size, err.what());
+        }
+        destroyBuffer(device, allocated);
+    }
+    return allocated;
+}
+
+void destroyBuffer(const Device &device, AllocatedBuffer &buffer) {
+    device.destroyBuffer(buffer.buffer);
+    device.freeMemory(buffer.memory);
+    buffer = AllocatedBuffer();
+}
@@ -1,15 +1,28 @@
 #include "Nest/Renderer/Vulkan/Pipeline.hpp"
 #include "Nest/Renderer/Vulkan/Shaders.hpp"
+#include "Nest/Renderer/Vulkan/Hash.hpp"
 #include "Nest/Logger/Logger.hpp"
 
 #include <vector>
 #include <sstream>
 
 PipelineLayout makePipelineLayout(const Device &device, bool debug) {
+    return makePipelineLayout(device, {}, debug);
+}
+
+PipelineLayout makePipelineLayout(const Device &device, const std::vector<DescriptorSetLayout> &setLayouts,
+                                  bool debug) {
+    return makePipelineLayout(device, setLayouts, {}, debug);
+}
+
+PipelineLayout makePipelineLayout(const Device &device, const std::vector<DescriptorSetLayout> &setLayouts,
+                                  const std::vector<PushConstantRange> &pushConstantRanges, bool debug) {
     PipelineLayoutCreateInfo layoutInfo;
     layoutInfo.flags = PipelineLayoutCreateFlags();
-    layoutInfo.setLayoutCount = 0;
-    layoutInfo.pushConstantRangeCount = 0;
+    layoutInfo.setLayoutCount = setLayouts.size();
+    layoutInfo.pSetLayouts = setLayouts.data();
+    layoutInfo.pushConstantRangeCount = pushConstantRanges.size();
+    layoutInfo.pPushConstantRanges = pushConstantRanges.data();
     try {
         return device.createPipelineLayout(layoutInfo);
     } catch (const SystemError &err) {
@@ -29,8 +42,9 @@ RenderPass makeRenderpass(const Device &device, const Format &swapchainImageForm
     colorAttachment.storeOp = AttachmentStoreOp::eStore;
     colorAttachment.stencilLoadOp = AttachmentLoadOp::eDontCare;
     colorAttachment.stencilStoreOp = AttachmentStoreOp::eDontCare;
-    colorAttachment.initialLayout = ImageLayout::eUndefined;
-    colorAttachment.finalLayout = ImageLayout::ePresentSrcKHR;
+    // The render graph transitions the image around the pass
+    colorAttachment.initialLayout = ImageLayout::eColorAttachmentOptimal;
+    colorAttachment.finalLayout = ImageLayout::eColorAttachmentOptimal;
 
     // Declare that attachment to be color buffer 0 of the framebuffer
     AttachmentReference colorAttachmentRef;
@@ -60,27 +74,225 @@ RenderPass makeRenderpass(const Device &device, const Format &swapchainImageForm
     }
 }
 
+static PrimitiveTopology getTopologyClass(const PrimitiveTopology &topology) {
+    switch (topology) {
+        case PrimitiveTopology::ePointList:
+            return PrimitiveTopology::ePointList;
+        case PrimitiveTopology::eLineList:
+        case PrimitiveTopology::eLineStrip:
+        case PrimitiveTopology::eLineListWithAdjacency:
+        case PrimitiveTopology::eLineStripWithAdjacency:
+            return PrimitiveTopology::eLineList;
+        case PrimitiveTopology::ePatchList:
+            return PrimitiveTopology::ePatchList;
+        default:
+            return PrimitiveTopology::eTriangleList;
+    }
+}
+
+RasterState getBakedRasterState(const RasterState &rasterState, const DynamicRasterState &dynamicState) {
+    RasterState defaults;
+    RasterState baked = rasterState;
+    if (dynamicState.extendedDynamicState) {
+        // Only the topology class has to match the pipeline
+        baked.topology = getTopologyClass(rasterState.topology);
+        baked.cullMode = defaults.cullMode;
+        baked.frontFace = defaults.frontFace;
+        baked.depthTest = defaults.depthTest;
+        baked.depthWrite = defaults.depthWrite;
+        baked.depthCompareOp = defaults.depthCompareOp;
+    }
+    if (dynamicState.extendedDynamicState2) {
+        baked.primitiveRestart = defaults.primitiveRestart;
+        baked.depthBias = defaults.depthBias;
+    }
+    if (dynamicState.polygonMode) {
+        baked.polygonMode = defaults.polygonMode;
+    }
+    if (dynamicState.blendEnable) {
+        baked.blendEnable = defaults.blendEnable;
+    }
+    return baked;
+}
+
+size_t hashRasterState(const RasterState &rasterState) {
+    size_t hash = 0;
+    hashCombine(hash, static_cast<uint32_t>(rasterState.topology));
+    hashCombine(hash, static_cast<uint32_t>(rasterState.cullMode));
+    hashCombine(hash, static_cast<uint32_t>(rasterState.frontFace));
+    hashCombine(hash, rasterState.depthTest);
+    hashCombine(hash, rasterState.depthWrite);
+    hashCombine(hash, static_cast<uint32_t>(rasterState.depthCompareOp));
+    hashCombine(hash, rasterState.primitiveRestart);
+    hashCombine(hash, rasterState.depthBias);
+    hashCombine(hash, static_cast<uint32_t>(rasterState.polygonMode));
+    hashCombine(hash, rasterState.blendEnable);
+    return hash;
+}
+
+void setDynamicRasterState(const CommandBuffer &commandBuffer, const RasterState &rasterState,
+                           const DynamicRasterState &dynamicState, const DispatchLoaderDynamic &dld) {
+    if (dynamicState.extendedDynamicState) {
+        commandBuffer.setPrimitiveTopologyEXT(rasterState.topology, dld);
+        commandBuffer.setCullModeEXT(rasterState.cullMode, dld);
+        commandBuffer.setFrontFaceEXT(rasterState.frontFace, dld);
+        commandBuffer.setDepthTestEnableEXT(rasterState.depthTest, dld);
+        commandBuffer.setDepthWriteEnableEXT(rasterState.depthWrite, dld);
+        commandBuffer.setDepthCompareOpEXT(rasterState.depthCompareOp, dld);
+    }
+    if (dynamicState.extendedDynamicState2) {
+        commandBuffer.setPrimitiveRestartEnableEXT(rasterState.primitiveRestart, dld);
+        commandBuffer.setDepthBiasEnableEXT(rasterState.depthBias, dld);
+    }
+    if (dynamicState.polygonMode) {
+        commandBuffer.setPolygonModeEXT(rasterState.polygonMode, dld);
+    }
+    if (dynamicState.blendEnable) {
+        Bool32 blendEnable = rasterState.blendEnable;
+        commandBuffer.setColorBlendEnableEXT(0, 1, &blendEnable, dld);
+    }
+}
+
+void fillGraphicsPipelineState(const GraphicsPipelineInBundle &specification, GraphicsPipelineState &state) {
+    RasterState rasterState = getBakedRasterState(specification.rasterState, specification.dynamicState);
+
+    // Vertex Input
+    state.vertexInputInfo.flags = PipelineVertexInputStateCreateFlags();
+    state.vertexInputInfo.vertexBindingDescriptionCount = 0;
+    state.vertexInputInfo.vertexAttributeDescriptionCount = 0;
+
+    //Input Assembly
+    state.inputAssemblyInfo.flags = PipelineInputAssemblyStateCreateFlags();
+    state.inputAssemblyInfo.topology = rasterState.topology;
+    state.inputAssemblyInfo.primitiveRestartEnable = rasterState.primitiveRestart;
+
+    // Viewport and Scissor, the actual rectangles are set while recording commands
+    state.viewportState.flags = PipelineViewportStateCreateFlags();
+    state.viewportState.viewportCount = 1;
+    state.viewportState.pViewports = nullptr;
+    state.viewportState.scissorCount = 1;
+    state.viewportState.pScissors = nullptr;
+
+    // Rasterizer
+    state.rasterizer.flags = PipelineRasterizationStateCreateFlags();
+    state.rasterizer.depthClampEnable = VK_FALSE; // discard out of bounds fragments, don't clamp them
+    state.rasterizer.rasterizerDiscardEnable = VK_FALSE; // This flag would disable fragment output
+    state.rasterizer.polygonMode = rasterState.polygonMode;
+    state.rasterizer.lineWidth = 1.0f;
+    state.rasterizer.cullMode = rasterState.cullMode; // back not renderer
+    state.rasterizer.frontFace = rasterState.frontFace;
+    state.rasterizer.depthBiasEnable = rasterState.depthBias; // Depth bias can be useful in shadow maps.
+
+    // Multisampling
+    state.multisampling.flags = PipelineMultisampleStateCreateFlags();
+    state.multisampling.sampleShadingEnable = VK_FALSE;
+    state.multisampling.rasterizationSamples = SampleCountFlagBits::e1;
+
+    // Depth and stencil
+    state.depthStencil.flags = PipelineDepthStencilStateCreateFlags();
+    state.depthStencil.depthTestEnable = rasterState.depthTest;
+    state.depthStencil.depthWriteEnable = rasterState.depthWrite;
+    state.depthStencil.depthCompareOp = rasterState.depthCompareOp;
+
+    // Color Blend
+    state.colorBlendAttachment.colorWriteMask =
+            ColorComponentFlagBits::eR | ColorComponentFlagBits::eG | ColorComponentFlagBits::eB |
+            ColorComponentFlagBits::eA;
+    state.colorBlendAttachment.blendEnable = rasterState.blendEnable;
+    state.colorBlendAttachment.srcColorBlendFactor = BlendFactor::eSrcAlpha;
+    state.colorBlendAttachment.dstColorBlendFactor = BlendFactor::eOneMinusSrcAlpha;
+    state.colorBlendAttachment.colorBlendOp = BlendOp::eAdd;
+    state.colorBlendAttachment.srcAlphaBlendFactor = BlendFactor::eOne;
+    state.colorBlendAttachment.dstAlphaBlendFactor = BlendFactor::eZero;
+    state.colorBlendAttachment.alphaBlendOp = BlendOp::eAdd;
+    state.colorBlending.flags = PipelineColorBlendStateCreateFlags();
+    state.colorBlending.logicOpEnable = VK_FALSE;
+    state.colorBlending.logicOp = LogicOp::eCopy;
+    state.colorBlending.attachmentCount = 1;
+    state.colorBlending.pAttachments = &state.colorBlendAttachment;
+    state.colorBlending.blendConstants[0] = 0.0f;
+    state.colorBlending.blendConstants[1] = 0.0f;
+    state.colorBlending.blendConstants[2] = 0.0f;
+    state.colorBlending.blendConstants[3] = 0.0f;
+
+    // Dynamic rendering
+    state.colorAttachmentFormat = specification.swapchainImageFormat;
+    state.renderingInfo.colorAttachmentCount = 1;
+    state.renderingInfo.pColorAttachmentFormats = &state.colorAttachmentFormat;
+
+    // Dynamic state
+    state.dynamicStates = {DynamicState::eViewport, DynamicState::eScissor};
+    if (specification.dynamicState.extendedDynamicState) {
+        state.dynamicStates.insert(state.dynamicStates.end(), {
+                DynamicState::ePrimitiveTopologyEXT, DynamicState::eCullModeEXT, DynamicState::eFrontFaceEXT,
+                DynamicState::eDepthTestEnableEXT, DynamicState::eDepthWriteEnableEXT,
+                DynamicState::eDepthCompareOpEXT
+        });
+    }
+    if (specification.dynamicState.extendedDynamicState2) {
+        state.dynamicStates.insert(state.dynamicStates.end(), {
+                DynamicState::ePrimitiveRestartEnableEXT, DynamicState::eDepthBiasEnableEXT
+        });
+    }
+    if (specification.dynamicState.polygonMode) {
+        state.dynamicStates.emplace_back(DynamicState::ePolygonModeEXT);
+    }
+    if (specification.dynamicState.blendEnable) {
+        state.dynamicStates.emplace_back(DynamicState::eColorBlendEnableEXT);
+    }
+    state.dynamicState.flags = PipelineDynamicStateCreateFlags();
+    state.dynamicState.dynamicStateCount = state.dynamicStates.size();
+    state.dynamicState.pDynamicStates = state.dynamicStates.data();
+}
+
+PipelineShaderStageCreateInfo makeShaderStage(const ShaderStageFlagBits &stage, const ShaderModule &module) {
+    PipelineShaderStageCreateInfo shaderInfo;
+    shaderInfo.flags = PipelineShaderStageCreateFlags();
+    shaderInfo.stage = stage;
+    shaderInfo.module = module;
+    shaderInfo.pName = "main";
+    return shaderInfo;
+}
+
 GraphicsPipelineOutBundle
 makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, bool debug) {
+    // Pipeline Layout(can set uniform, textures)
+    if (debug) {
+        LOG_INFO("Create Pipeline Layout");
+    }
+    PipelineLayout pipelineLayout = makePipelineLayout(specification.device, debug);
+    // RenderPass
+    if (debug) {
+        LOG_INFO("Create RenderPass");
+    }
+    RenderPass renderPass = makeRenderpass(specification.device, specification.swapchainImageFormat, debug);
+
+    GraphicsPipelineOutBundle output;
+    output.layout = pipelineLayout;
+    output.renderPass = renderPass;
+    output.pipeline = makeGraphicsPipeline(specification, pipelineLayout, renderPass, debug);
+    return output;
+}
+
+Pipeline makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, const PipelineLayout &layout,
+                              const RenderPass &renderPass, bool debug) {
     // The info for the graphics pipeline
     GraphicsPipelineCreateInfo pipelineCreateInfo;
     pipelineCreateInfo.flags = PipelineCreateFlags();
 
-    // Shader stages, to be populated later
-    std::vector<PipelineShaderStageCreateInfo> shaderStages;
-
-    // Vertex Input
-    PipelineVertexInputStateCreateInfo vertexInputInfo;
-    vertexInputInfo.flags = PipelineVertexInputStateCreateFlags();
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    pipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(specification, state);
+    pipelineCreateInfo.pVertexInputState = &state.vertexInputInfo;
+    pipelineCreateInfo.pInputAssemblyState = &state.inputAssemblyInfo;
+    pipelineCreateInfo.pViewportState = &state.viewportState;
+    pipelineCreateInfo.pRasterizationState = &state.rasterizer;
+    pipelineCreateInfo.pMultisampleState = &state.multisampling;
+    pipelineCreateInfo.pDepthStencilState = &state.depthStencil;
+    pipelineCreateInfo.pColorBlendState = &state.colorBlending;
+    pipelineCreateInfo.pDynamicState = &state.dynamicState;
 
-    //Input Assembly
-    PipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
-    inputAssemblyInfo.flags = PipelineInputAssemblyStateCreateFlags();
-    inputAssemblyInfo.topology = PrimitiveTopology::eTriangleList;
-    pipelineCreateInfo.pInputAssemblyState = &inputAssemblyInfo;
+    // Shader stages
+    std::vector<PipelineShaderStageCreateInfo> shaderStages;
 
     // Vertex Shader
     if (debug) {
@@ -89,44 +301,7 @@ makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, bool debug)
     ShaderModule vertexShader = createModule(
             specification.vertexFilepath, specification.device, debug
     );
-    PipelineShaderStageCreateInfo vertexShaderInfo;
-    vertexShaderInfo.flags = PipelineShaderStageCreateFlags();
-    vertexShaderInfo.stage = ShaderStageFlagBits::eVertex;
-    vertexShaderInfo.module = vertexShader;
-    vertexShaderInfo.pName = "main";
-    shaderStages.push_back(vertexShaderInfo);
-
-    // Viewport and Scissor
-    Viewport viewport;
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float) specification.swapchainExtent.width;
-    viewport.height = (float) specification.swapchainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    Rect2D scissor;
-    scissor.offset.x = 0.0f;
-    scissor.offset.y = 0.0f;
-    scissor.extent = specification.swapchainExtent;
-    PipelineViewportStateCreateInfo viewportState;
-    viewportState.flags = PipelineViewportStateCreateFlags();
-    viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
-    viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
-    pipelineCreateInfo.pViewportState = &viewportState;
-
-    // Rasterizer
-    PipelineRasterizationStateCreateInfo rasterizer;
-    rasterizer.flags = PipelineRasterizationStateCreateFlags();
-    rasterizer.depthClampEnable = VK_FALSE; // discard out of bounds fragments, don't clamp them
-    rasterizer.rasterizerDiscardEnable = VK_FALSE; // This flag would disable fragment output
-    rasterizer.polygonMode = PolygonMode::eFill;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = CullModeFlagBits::eBack; // back not renderer
-    rasterizer.frontFace = FrontFace::eClockwise;
-    rasterizer.depthBiasEnable = VK_FALSE; // Depth bias can be useful in shadow maps.
-    pipelineCreateInfo.pRasterizationState = &rasterizer;
+    shaderStages.push_back(makeShaderStage(ShaderStageFlagBits::eVertex, vertexShader));
 
     // Fragment Shader
     if (debug) {
@@ -135,55 +310,17 @@ makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, bool debug)
     ShaderModule fragmentShader = createModule(
             specification.fragmentFilepath, specification.device, debug
     );
-    PipelineShaderStageCreateInfo fragmentShaderInfo;
-    fragmentShaderInfo.flags = PipelineShaderStageCreateFlags();
-    fragmentShaderInfo.stage = ShaderStageFlagBits::eFragment;
-    fragmentShaderInfo.module = fragmentShader;
-    fragmentShaderInfo.pName = "main";
-    shaderStages.emplace_back(fragmentShaderInfo);
+    shaderStages.emplace_back(makeShaderStage(ShaderStageFlagBits::eFragment, fragmentShader));
     // Now both shaders have been made, we can declare them to the pipeline info
     pipelineCreateInfo.stageCount = shaderStages.size();
     pipelineCreateInfo.pStages = shaderStages.data();
 
-
-    // Multisampling
-    PipelineMultisampleStateCreateInfo multisampling;
-    multisampling.flags = PipelineMultisampleStateCreateFlags();
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = SampleCountFlagBits::e1;
-    pipelineCreateInfo.pMultisampleState = &multisampling;
-
-    // Color Blend
-    PipelineColorBlendAttachmentState colorBlendAttachment;
-    colorBlendAttachment.colorWriteMask =
-            ColorComponentFlagBits::eR | ColorComponentFlagBits::eG | ColorComponentFlagBits::eB |
-            ColorComponentFlagBits::eA;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    PipelineColorBlendStateCreateInfo colorBlending;
-    colorBlending.flags = PipelineColorBlendStateCreateFlags();
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = LogicOp::eCopy;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
-    pipelineCreateInfo.pColorBlendState = &colorBlending;
-
-    // Pipeline Layout(can set uniform, textures)
-    if (debug) {
-        LOG_INFO("Create Pipeline Layout");
-    }
-    PipelineLayout pipelineLayout = makePipelineLayout(specification.device, debug);
-    pipelineCreateInfo.layout = pipelineLayout;
-    // RenderPass
-    if (debug) {
-        LOG_INFO("Create RenderPass");
-    }
-
-    RenderPass renderPass = makeRenderpass(specification.device, specification.swapchainImageFormat, debug);
+    pipelineCreateInfo.layout = layout;
     pipelineCreateInfo.renderPass = renderPass;
+    // Without a render pass the attachment formats come from dynamic rendering
+    if (!renderPass) {
+        pipelineCreateInfo.pNext = &state.renderingInfo;
+    }
 
     // Extra stuff
     pipelineCreateInfo.basePipelineHandle = nullptr;
@@ -202,13 +339,28 @@ makeGraphicsPipeline(const GraphicsPipelineInBundle &specification, bool debug)
         }
     }
 
-    GraphicsPipelineOutBundle output;
-    output.layout = pipelineLayout;
-    output.renderPass = renderPass;
-    output.pipeline = graphicsPipeline;
-
     specification.device.destroyShaderModule(vertexShader);
     specification.device.destroyShaderModule(fragmentShader);
 
-    return output;
-}
\ No newline at end of file
+    return graphicsPipeline;
+}
+
+Pipeline makeComputePipeline(const Device &device, const PipelineLayout &layout, const std::string &shaderFilepath,
+                             bool debug) {
+    ShaderModule computeShader = createModule(shaderFilepath, device, debug);
+
+    ComputePipelineCreateInfo pipelineInfo;
+    pipelineInfo.stage = makeShaderStage(ShaderStageFlagBits::eCompute, computeShader);
+    pipelineInfo.layout = layout;
+
+    Pipeline pipeline;
+    try {
+        pipeline = device.createComputePipeline(nullptr, pipelineInfo).value;
+    } catch (const SystemError &err) {
+        if (debug) {
+            LOG_ERROR("Failed to create compute pipeline \"{}\"\n{}", shaderFilepath, err.what());
+        }
+    }
+    device.destroyShaderModule(computeShader);
+    return pipeline;
+}
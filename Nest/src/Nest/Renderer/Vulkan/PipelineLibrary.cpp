@@ -0,0 +1,328 @@
+#include "Nest/Renderer/Vulkan/PipelineLibrary.hpp"
+#include "Nest/Renderer/Vulkan/Shaders.hpp"
+#include "Nest/Renderer/Vulkan/Hash.hpp"
+#include "Nest/Logger/Logger.hpp"
+#include "Nest/Settings/SettingsLog.hpp"
+
+#include <chrono>
+
+static size_t hashDynamicState(const DynamicRasterState &dynamicState) {
+    size_t hash = 0;
+    hashCombine(hash, dynamicState.extendedDynamicState);
+    hashCombine(hash, dynamicState.extendedDynamicState2);
+    hashCombine(hash, dynamicState.polygonMode);
+    hashCombine(hash, dynamicState.blendEnable);
+    return hash;
+}
+
+void PipelineLibrary::init(const Device &device, DeletionQueue &deletionQueue, bool useLibrary, bool fastLinking,
+                           bool debug) {
+    m_device = device;
+    m_deletionQueue = &deletionQueue;
+    m_useLibrary = useLibrary;
+    m_fastLinking = fastLinking;
+    m_debug = debug;
+
+    PipelineCacheCreateInfo cacheInfo;
+    cacheInfo.flags = PipelineCacheCreateFlags();
+    try {
+        m_cache = m_device.createPipelineCache(cacheInfo);
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to create pipeline cache\n{}", err.what());
+        }
+        m_cache = nullptr;
+    }
+}
+
+void PipelineLibrary::destroy() {
+    for (auto &linked: m_pipelines) {
+        if (linked.pending.valid()) {
+            Pipeline optimized = linked.pending.get();
+            m_device.destroyPipeline(optimized);
+        }
+        m_device.destroyPipeline(linked.current);
+    }
+    for (auto *parts: {&m_vertexInputParts, &m_preRasterizationParts, &m_fragmentShaderParts,
+                       &m_fragmentOutputParts}) {
+        for (const auto &part: *parts) {
+            m_device.destroyPipeline(part.second);
+        }
+        parts->clear();
+    }
+    m_pipelines.clear();
+    m_pipelineIds.clear();
+    m_device.destroyPipelineCache(m_cache);
+}
+
+Pipeline PipelineLibrary::makePart(GraphicsPipelineCreateInfo &pipelineInfo, GraphicsPipelineLibraryFlagsEXT flags) {
+    GraphicsPipelineLibraryCreateInfoEXT libraryInfo;
+    libraryInfo.flags = flags;
+    libraryInfo.pNext = const_cast<void *>(pipelineInfo.pNext);
+    pipelineInfo.pNext = &libraryInfo;
+    // Keep the information needed to build the link time optimized pipeline later
+    pipelineInfo.flags |= PipelineCreateFlagBits::eLibraryKHR | PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+
+    try {
+        return m_device.createGraphicsPipeline(m_cache, pipelineInfo).value;
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to create pipeline library part\n{}", err.what());
+        }
+        return nullptr;
+    }
+}
+
+Pipeline PipelineLibrary::makeVertexInputPart(const GraphicsPipelineInBundle &specification) {
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(specification, state);
+
+    size_t key = hashDynamicState(specification.dynamicState);
+    hashCombine(key, static_cast<uint32_t>(state.inputAssemblyInfo.topology));
+    hashCombine(key, state.inputAssemblyInfo.primitiveRestartEnable);
+    hashCombine(key, state.vertexInputInfo.vertexBindingDescriptionCount);
+    hashCombine(key, state.vertexInputInfo.vertexAttributeDescriptionCount);
+    auto cached = m_vertexInputParts.find(key);
+    if (cached != m_vertexInputParts.end()) {
+        return cached->second;
+    }
+
+    GraphicsPipelineCreateInfo pipelineInfo;
+    pipelineInfo.pVertexInputState = &state.vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &state.inputAssemblyInfo;
+    pipelineInfo.pDynamicState = &state.dynamicState;
+    Pipeline part = makePart(pipelineInfo, GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface);
+    m_vertexInputParts[key] = part;
+    return part;
+}
+
+Pipeline PipelineLibrary::makePreRasterizationPart(const GraphicsPipelineInBundle &specification,
+                                                   const PipelineLayout &layout, const RenderPass &renderPass) {
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(specification, state);
+
+    size_t key = hashDynamicState(specification.dynamicState);
+    hashCombine(key, specification.vertexFilepath);
+    hashCombine(key, static_cast<uint32_t>(state.rasterizer.cullMode));
+    hashCombine(key, static_cast<uint32_t>(state.rasterizer.frontFace));
+    hashCombine(key, static_cast<uint32_t>(state.rasterizer.polygonMode));
+    hashCombine(key, state.rasterizer.depthBiasEnable);
+    hashCombine(key, handleValue(layout));
+    hashCombine(key, handleValue(renderPass));
+    auto cached = m_preRasterizationParts.find(key);
+    if (cached != m_preRasterizationParts.end()) {
+        return cached->second;
+    }
+
+    ShaderModule vertexShader = createModule(specification.vertexFilepath, m_device, m_debug);
+    PipelineShaderStageCreateInfo vertexShaderInfo = makeShaderStage(ShaderStageFlagBits::eVertex, vertexShader);
+
+    GraphicsPipelineCreateInfo pipelineInfo;
+    pipelineInfo.stageCount = 1;
+    pipelineInfo.pStages = &vertexShaderInfo;
+    pipelineInfo.pViewportState = &state.viewportState;
+    pipelineInfo.pRasterizationState = &state.rasterizer;
+    pipelineInfo.pDynamicState = &state.dynamicState;
+    pipelineInfo.layout = layout;
+    pipelineInfo.renderPass = renderPass;
+    if (!renderPass) {
+        pipelineInfo.pNext = &state.renderingInfo;
+    }
+    Pipeline part = makePart(pipelineInfo, GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders);
+
+    m_device.destroyShaderModule(vertexShader);
+    m_preRasterizationParts[key] = part;
+    return part;
+}
+
+Pipeline PipelineLibrary::makeFragmentShaderPart(const GraphicsPipelineInBundle &specification,
+                                                 const PipelineLayout &layout, const RenderPass &renderPass) {
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(specification, state);
+
+    size_t key = hashDynamicState(specification.dynamicState);
+    hashCombine(key, specification.fragmentFilepath);
+    hashCombine(key, state.depthStencil.depthTestEnable);
+    hashCombine(key, state.depthStencil.depthWriteEnable);
+    hashCombine(key, static_cast<uint32_t>(state.depthStencil.depthCompareOp));
+    hashCombine(key, handleValue(layout));
+    hashCombine(key, handleValue(renderPass));
+    auto cached = m_fragmentShaderParts.find(key);
+    if (cached != m_fragmentShaderParts.end()) {
+        return cached->second;
+    }
+
+    ShaderModule fragmentShader = createModule(specification.fragmentFilepath, m_device, m_debug);
+    PipelineShaderStageCreateInfo fragmentShaderInfo = makeShaderStage(ShaderStageFlagBits::eFragment,
+                                                                       fragmentShader);
+
+    GraphicsPipelineCreateInfo pipelineInfo;
+    pipelineInfo.stageCount = 1;
+    pipelineInfo.pStages = &fragmentShaderInfo;
+    pipelineInfo.pMultisampleState = &state.multisampling;
+    pipelineInfo.pDepthStencilState = &state.depthStencil;
+    pipelineInfo.pDynamicState = &state.dynamicState;
+    pipelineInfo.layout = layout;
+    pipelineInfo.renderPass = renderPass;
+    if (!renderPass) {
+        pipelineInfo.pNext = &state.renderingInfo;
+    }
+    Pipeline part = makePart(pipelineInfo, GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader);
+
+    m_device.destroyShaderModule(fragmentShader);
+    m_fragmentShaderParts[key] = part;
+    return part;
+}
+
+Pipeline PipelineLibrary::makeFragmentOutputPart(const GraphicsPipelineInBundle &specification,
+                                                 const RenderPass &renderPass) {
+    GraphicsPipelineState state;
+    fillGraphicsPipelineState(specification, state);
+
+    size_t key = hashDynamicState(specification.dynamicState);
+    hashCombine(key, static_cast<uint32_t>(specification.swapchainImageFormat));
+    hashCombine(key, state.colorBlendAttachment.blendEnable);
+    hashCombine(key, handleValue(renderPass));
+    auto cached = m_fragmentOutputParts.find(key);
+    if (cached != m_fragmentOutputParts.end()) {
+        return cached->second;
+    }
+
+
+    GraphicsPipelineCreateInfo pipelineInfo;
+    pipelineInfo.pMultisampleState = &state.multisampling;
+    pipelineInfo.pColorBlendState = &state.colorBlending;
+    pipelineInfo.pDynamicState = &state.dynamicState;
+    pipelineInfo.renderPass = renderPass;
+    if (!renderPass) {
+        pipelineInfo.pNext = &state.renderingInfo;
+    }
+    Pipeline part = makePart(pipelineInfo, GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface);
+
+    m_fragmentOutputParts[key] = part;
+    return part;
+}
+
+Pipeline PipelineLibrary::link(const std::array<Pipeline, 4> &parts, const PipelineLayout &layout, bool optimize) {
+    PipelineLibraryCreateInfoKHR libraryInfo;
+    libraryInfo.libraryCount = parts.size();
+    libraryInfo.pLibraries = parts.data();
+
+    GraphicsPipelineCreateInfo pipelineInfo;
+    pipelineInfo.pNext = &libraryInfo;
+    pipelineInfo.layout = layout;
+    if (optimize) {
+        pipelineInfo.flags = PipelineCreateFlagBits::eLinkTimeOptimizationEXT;
+    }
+
+    try {
+        return m_device.createGraphicsPipeline(m_cache, pipelineInfo).value;
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to link pipeline library\n{}", err.what());
+        }
+        return nullptr;
+    }
+}
+
+uint32_t PipelineLibrary::requestMonolithicPipeline(const GraphicsPipelineInBundle &specification,
+                                                    const PipelineLayout &layout, const RenderPass &renderPass) {
+    // Dynamic fields are not part of the key, so materials differing only in them share a pipeline
+    size_t key = hashDynamicState(specification.dynamicState);
+    hashCombine(key, specification.vertexFilepath);
+    hashCombine(key, specification.fragmentFilepath);
+    hashCombine(key, static_cast<uint32_t>(specification.swapchainImageFormat));
+    hashCombine(key, hashRasterState(getBakedRasterState(specification.rasterState, specification.dynamicState)));
+    hashCombine(key, handleValue(layout));
+    hashCombine(key, handleValue(renderPass));
+    auto cached = m_pipelineIds.find(key);
+    if (cached != m_pipelineIds.end()) {
+        return cached->second;
+    }
+
+    LinkedPipeline linked;
+    linked.current = makeGraphicsPipeline(specification, layout, renderPass, m_debug);
+    linked.optimized = true;
+
+    auto id = static_cast<uint32_t>(m_pipelines.size());
+    m_pipelines.emplace_back(std::move(linked));
+    m_pipelineIds[key] = id;
+    return id;
+}
+
+uint32_t PipelineLibrary::requestPipeline(const GraphicsPipelineInBundle &specification,
+                                          const PipelineLayout &layout, const RenderPass &renderPass) {
+    if (!m_useLibrary) {
+        return requestMonolithicPipeline(specification, layout, renderPass);
+    }
+
+    std::array<Pipeline, 4> parts = {
+            makeVertexInputPart(specification),
+            makePreRasterizationPart(specification, layout, renderPass),
+            makeFragmentShaderPart(specification, layout, renderPass),
+            makeFragmentOutputPart(specification, renderPass)
+    };
+
+    size_t key = 0;
+    for (const auto &part: parts) {
+        hashCombine(key, handleValue(part));
+    }
+    auto cached = m_pipelineIds.find(key);
+    if (cached != m_pipelineIds.end()) {
+        return cached->second;
+    }
+
+    LinkedPipeline linked;
+    if (m_fastLinking) {
+        linked.current = link(parts, layout, false);
+        // Parts are immutable and the pipeline cache is internally synchronized,
+        // so the optimized pipeline can be compiled on another thread
+        linked.pending = std::async(std::launch::async, [this, parts, layout]() {
+            return link(parts, layout, true);
+        });
+    } else {
+        // Without fast linking an unoptimized link costs about as much as the optimized one
+        linked.current = link(parts, layout, true);
+        linked.optimized = true;
+    }
+    if (VK_PRINT_GRAPTHICS_PIPELINE_INFO) {
+        LOG_INFO("Linked pipeline {} from library parts", m_pipelines.size());
+    }
+
+    auto id = static_cast<uint32_t>(m_pipelines.size());
+    m_pipelines.emplace_back(std::move(linked));
+    m_pipelineIds[key] = id;
+    return id;
+}
+
+Pipeline PipelineLibrary::getPipeline(uint32_t id) const {
+    return m_pipelines[id].current;
+}
+
+size_t PipelineLibrary::getPipelineCount() const {
+    return m_pipelines.size();
+}
+
+bool PipelineLibrary::update(uint64_t frame) {
+    bool changed = false;
+    for (auto &linked: m_pipelines) {
+        if (linked.optimized || !linked.pending.valid()) {
+            continue;
+        }
+        if (linked.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            continue;
+        }
+        Pipeline optimized = linked.pending.get();
+        if (!optimized) {
+            continue;
+        }
+        // Frames in flight may still reference the fast-linked pipeline
+        m_deletionQueue->push(frame, [device = m_device, pipeline = linked.current]() {
+            device.destroyPipeline(pipeline);
+        });
+        linked.current = optimized;
+        linked.optimized = true;
+        changed = true;
+    }
+    return changed;
+}
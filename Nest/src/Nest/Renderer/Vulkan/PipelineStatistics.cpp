@@ -0,0 +1,96 @@
+#include "Nest/Renderer/Vulkan/PipelineStatistics.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+static constexpr uint32_t invalidQuery = ~0u;
+
+void PipelineStatistics::init(const Device &device, uint32_t framesInFlight, bool debug) {
+    m_device = device;
+    m_debug = debug;
+
+    QueryPoolCreateInfo createInfo;
+    createInfo.queryType = QueryType::ePipelineStatistics;
+    createInfo.queryCount = maxPassesPerFrame;
+    createInfo.pipelineStatistics = flags;
+    m_frames.resize(framesInFlight);
+    for (auto &frame: m_frames) {
+        try {
+            frame.pool = m_device.createQueryPool(createInfo);
+        } catch (const SystemError &err) {
+            if (m_debug) {
+                LOG_ERROR("Failed to create pipeline statistics query pool\n{}", err.what());
+            }
+            destroy();
+            return;
+        }
+    }
+}
+
+void PipelineStatistics::destroy() {
+    for (auto &frame: m_frames) {
+        if (frame.pool) {
+            m_device.destroyQueryPool(frame.pool);
+        }
+    }
+    m_frames.clear();
+}
+
+bool PipelineStatistics::isEnabled() const {
+    return !m_frames.empty();
+}
+
+void PipelineStatistics::beginFrame(uint32_t frameIndex, const CommandBuffer &commandBuffer) {
+    m_frameIndex = frameIndex;
+    FrameData &frame = m_frames[frameIndex];
+    readResults(frame);
+    frame.passes.clear();
+    commandBuffer.resetQueryPool(frame.pool, 0, maxPassesPerFrame);
+}
+
+void PipelineStatistics::readResults(FrameData &frame) {
+    if (frame.passes.empty()) {
+        return;
+    }
+    auto passCount = static_cast<uint32_t>(frame.passes.size());
+    std::vector<uint64_t> counters(passCount * counterCount);
+    // Without the wait flag an incomplete frame reports eNotReady instead of blocking
+    Result result = m_device.getQueryPoolResults(frame.pool, 0, passCount, counters.size() * sizeof(uint64_t),
+                                                 counters.data(), counterCount * sizeof(uint64_t),
+                                                 QueryResultFlagBits::e64);
+    if (result != Result::eSuccess) {
+        return;
+    }
+
+    m_results.clear();
+    for (uint32_t i = 0; i < passCount; ++i) {
+        // Values come in the order of the flag bits
+        const uint64_t *values = &counters[i * counterCount];
+        PassStatistics &pass = m_results.emplace_back();
+        pass.name = frame.passes[i];
+        pass.inputVertices = values[0];
+        pass.vertexShaderInvocations = values[1];
+        pass.clippingPrimitives = values[2];
+        pass.fragmentShaderInvocations = values[3];
+        pass.computeShaderInvocations = values[4];
+    }
+}
+
+uint32_t PipelineStatistics::begin(const CommandBuffer &commandBuffer, const std::string &name) {
+    FrameData &frame = m_frames[m_frameIndex];
+    if (frame.passes.size() >= maxPassesPerFrame) {
+        return invalidQuery;
+    }
+    auto query = static_cast<uint32_t>(frame.passes.size());
+    frame.passes.push_back(name);
+    commandBuffer.beginQuery(frame.pool, query, QueryControlFlags());
+    return query;
+}
+
+void PipelineStatistics::end(const CommandBuffer &commandBuffer, uint32_t query) {
+    if (query != invalidQuery) {
+        commandBuffer.endQuery(m_frames[m_frameIndex].pool, query);
+    }
+}
+
+const std::vector<PassStatistics> &PipelineStatistics::getPasses() const {
+    return m_results;
+}
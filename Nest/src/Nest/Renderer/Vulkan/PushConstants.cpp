@@ -0,0 +1,17 @@
+#include "Nest/Renderer/Vulkan/PushConstants.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+bool validatePushConstantRanges(const PhysicalDevice &physicalDevice, const std::vector<PushConstantRange> &ranges,
+                                bool debug) {
+    uint32_t maxSize = physicalDevice.getProperties().limits.maxPushConstantsSize;
+    for (const auto &range: ranges) {
+        if (range.offset % 4 != 0 || range.size % 4 != 0 || range.offset + range.size > maxSize) {
+            if (debug) {
+                LOG_ERROR("Push constant range [{}, {}) does not fit in maxPushConstantsSize {}",
+                          range.offset, range.offset + range.size, maxSize);
+            }
+            return false;
+        }
+    }
+    return true;
+}
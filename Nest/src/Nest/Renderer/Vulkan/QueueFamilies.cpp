@@ -33,6 +33,41 @@ findQueueFamilies(const PhysicalDevice &physicalDevice, const SurfaceKHR &surfac
         }
         i++;
     }
+
+    if (indices.graphicsFamily.has_value()) {
+        uint32_t graphicsFamily = indices.graphicsFamily.value();
+        for (uint32_t family = 0; family < queueFamilies.size(); ++family) {
+            QueueFlags flags = queueFamilies[family].queueFlags;
+            if (family == graphicsFamily || !(flags & QueueFlagBits::eCompute)) {
+                continue;
+            }
+            // Families without graphics usually map to separate hardware queues
+            if (!indices.computeFamily.has_value() || !(flags & QueueFlagBits::eGraphics)) {
+                indices.computeFamily = family;
+            }
+            if (!(flags & QueueFlagBits::eGraphics)) {
+                break;
+            }
+        }
+        if (!indices.computeFamily.has_value() && queueFamilies[graphicsFamily].queueCount > 1) {
+            indices.computeFamily = graphicsFamily;
+            indices.computeQueueIndex = 1;
+        }
+        if (debug && indices.computeFamily.has_value()) {
+            message << "\n\tQueue " << indices.computeQueueIndex << " of Queue Family " << indices.computeFamily.value()
+                    << " is used for async compute";
+        }
+    }
+    for (uint32_t family = 0; family < queueFamilies.size(); ++family) {
+        QueueFlags flags = queueFamilies[family].queueFlags;
+        if ((flags & QueueFlagBits::eTransfer) && !(flags & (QueueFlagBits::eGraphics | QueueFlagBits::eCompute))) {
+            indices.transferFamily = family;
+            if (debug) {
+                message << "\n\tQueue Family " << family << " is used for uploads";
+            }
+            break;
+        }
+    }
     if (debug) {
         LOG_INFO("{}", message.str());
     }
@@ -0,0 +1,707 @@
+#include <algorithm>
+#include <sstream>
+
+#include "Nest/Renderer/Vulkan/RenderGraph.hpp"
+#include "Nest/Renderer/Vulkan/Memory.hpp"
+#include "Nest/Renderer/Vulkan/Hash.hpp"
+#include "Nest/Renderer/Vulkan/GpuProfiler.hpp"
+#include "Nest/Logger/Logger.hpp"
+#include "Nest/Settings/SettingsLog.hpp"
+
+struct AccessInfo {
+    PipelineStageFlags2 stages;
+    AccessFlags2 access;
+    ImageLayout layout;
+    ImageUsageFlags imageUsage;
+    BufferUsageFlags bufferUsage;
+};
+
+static AccessInfo getAccessInfo(RenderGraphAccess access, bool write) {
+    PipelineStageFlags2 shaderStages = PipelineStageFlagBits2::eVertexShader |
+                                       PipelineStageFlagBits2::eFragmentShader |
+                                       PipelineStageFlagBits2::eComputeShader;
+    switch (access) {
+        case RenderGraphAccess::ColorAttachment:
+            return {PipelineStageFlagBits2::eColorAttachmentOutput,
+                    write ? AccessFlagBits2::eColorAttachmentWrite : AccessFlagBits2::eColorAttachmentRead,
+                    ImageLayout::eColorAttachmentOptimal, ImageUsageFlagBits::eColorAttachment, {}};
+        case RenderGraphAccess::DepthAttachment:
+            return {PipelineStageFlagBits2::eEarlyFragmentTests | PipelineStageFlagBits2::eLateFragmentTests,
+                    write ? AccessFlagBits2::eDepthStencilAttachmentWrite
+                          : AccessFlagBits2::eDepthStencilAttachmentRead,
+                    ImageLayout::eDepthStencilAttachmentOptimal, ImageUsageFlagBits::eDepthStencilAttachment, {}};
+        case RenderGraphAccess::DepthRead:
+            return {PipelineStageFlagBits2::eEarlyFragmentTests | PipelineStageFlagBits2::eFragmentShader,
+                    AccessFlagBits2::eDepthStencilAttachmentRead | AccessFlagBits2::eShaderRead,
+                    ImageLayout::eDepthStencilReadOnlyOptimal,
+                    ImageUsageFlagBits::eDepthStencilAttachment | ImageUsageFlagBits::eSampled, {}};
+        case RenderGraphAccess::Sampled:
+            return {shaderStages, AccessFlagBits2::eShaderRead, ImageLayout::eShaderReadOnlyOptimal,
+                    ImageUsageFlagBits::eSampled, BufferUsageFlagBits::eUniformBuffer};
+        case RenderGraphAccess::StorageRead:
+            return {shaderStages, AccessFlagBits2::eShaderRead, ImageLayout::eGeneral,
+                    ImageUsageFlagBits::eStorage, BufferUsageFlagBits::eStorageBuffer};
+        case RenderGraphAccess::StorageWrite:
+            return {shaderStages, AccessFlagBits2::eShaderRead | AccessFlagBits2::eShaderWrite,
+                    ImageLayout::eGeneral, ImageUsageFlagBits::eStorage, BufferUsageFlagBits::eStorageBuffer};
+        case RenderGraphAccess::TransferRead:
+            return {PipelineStageFlagBits2::eTransfer, AccessFlagBits2::eTransferRead,
+                    ImageLayout::eTransferSrcOptimal, ImageUsageFlagBits::eTransferSrc,
+                    BufferUsageFlagBits::eTransferSrc};
+        case RenderGraphAccess::TransferWrite:
+            return {PipelineStageFlagBits2::eTransfer, AccessFlagBits2::eTransferWrite,
+                    ImageLayout::eTransferDstOptimal, ImageUsageFlagBits::eTransferDst,
+                    BufferUsageFlagBits::eTransferDst};
+        case RenderGraphAccess::IndirectRead:
+            return {PipelineStageFlagBits2::eDrawIndirect, AccessFlagBits2::eIndirectCommandRead,
+                    ImageLayout::eUndefined, {}, BufferUsageFlagBits::eIndirectBuffer};
+        case RenderGraphAccess::VertexRead:
+            return {PipelineStageFlagBits2::eVertexInput,
+                    AccessFlagBits2::eVertexAttributeRead | AccessFlagBits2::eIndexRead, ImageLayout::eUndefined,
+                    {}, BufferUsageFlagBits::eVertexBuffer | BufferUsageFlagBits::eIndexBuffer};
+    }
+    return {};
+}
+
+static ImageAspectFlags getAspect(Format format) {
+    switch (format) {
+        case Format::eD16Unorm:
+        case Format::eD32Sfloat:
+        case Format::eX8D24UnormPack32:
+            return ImageAspectFlagBits::eDepth;
+        case Format::eD16UnormS8Uint:
+        case Format::eD24UnormS8Uint:
+        case Format::eD32SfloatS8Uint:
+            return ImageAspectFlagBits::eDepth | ImageAspectFlagBits::eStencil;
+        default:
+            return ImageAspectFlagBits::eColor;
+    }
+}
+
+RenderGraphBuilder::RenderGraphBuilder(RenderGraph &graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+
+void RenderGraphBuilder::createTexture(const std::string &name, const RenderGraphTextureDesc &desc) {
+    RenderGraph::Resource resource;
+    resource.name = name;
+    resource.isTexture = true;
+    resource.texture = desc;
+    m_graph.addResource(resource);
+}
+
+void RenderGraphBuilder::createBuffer(const std::string &name, const RenderGraphBufferDesc &desc) {
+    RenderGraph::Resource resource;
+    resource.name = name;
+    resource.isTexture = false;
+    resource.buffer = desc;
+    m_graph.addResource(resource);
+}
+
+void RenderGraphBuilder::read(const std::string &name, RenderGraphAccess access) {
+    uint32_t resource = m_graph.findResource(name);
+    if (resource == UINT32_MAX) {
+        return;
+    }
+    m_graph.m_passes[m_pass].accesses.push_back({resource, access, false});
+}
+
+void RenderGraphBuilder::write(const std::string &name, RenderGraphAccess access) {
+    uint32_t resource = m_graph.findResource(name);
+    if (resource == UINT32_MAX) {
+        return;
+    }
+    m_graph.m_passes[m_pass].accesses.push_back({resource, access, true});
+}
+
+void RenderGraphBuilder::setSideEffect() {
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+void RenderGraph::init(const Device &device, const PhysicalDevice &physicalDevice, DeletionQueue &deletionQueue,
+                       ResourceStateTracker &stateTracker, bool debug) {
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_deletionQueue = &deletionQueue;
+    m_stateTracker = &stateTracker;
+    m_debug = debug;
+}
+
+void RenderGraph::destroy() {
+    for (const auto &view: m_physical.imageViews) {
+        m_device.destroyImageView(view.second);
+    }
+    for (const auto &image: m_physical.images) {
+        m_device.destroyImage(image.second);
+    }
+    for (const auto &buffer: m_physical.buffers) {
+        m_device.destroyBuffer(buffer.second);
+    }
+    for (const auto &memory: m_physical.memory) {
+        m_device.freeMemory(memory);
+    }
+    m_physical = PhysicalResources();
+    m_resources.clear();
+    m_resourceIds.clear();
+    m_passes.clear();
+}
+
+void RenderGraph::reset(uint64_t frame) {
+    m_frame = frame;
+    m_resources.clear();
+    m_resourceIds.clear();
+    m_passes.clear();
+}
+
+uint32_t RenderGraph::addResource(const Resource &resource) {
+    if (m_resourceIds.count(resource.name)) {
+        if (m_debug) {
+            LOG_ERROR("Render graph resource \"{}\" is declared twice", resource.name);
+        }
+        return m_resourceIds[resource.name];
+    }
+    auto id = static_cast<uint32_t>(m_resources.size());
+    m_resources.emplace_back(resource);
+    m_resourceIds[resource.name] = id;
+    return id;
+}
+
+uint32_t RenderGraph::findResource(const std::string &name) const {
+    auto found = m_resourceIds.find(name);
+    if (found == m_resourceIds.end()) {
+        if (m_debug) {
+            LOG_ERROR("Render graph resource \"{}\" is not declared", name);
+        }
+        return UINT32_MAX;
+    }
+    return found->second;
+}
+
+void RenderGraph::importTexture(const std::string &name, const Image &image, const ImageView &imageView,
+                                const RenderGraphTextureDesc &desc, ImageLayout initialLayout,
+                                ImageLayout finalLayout) {
+    Resource resource;
+    resource.name = name;
+    resource.isTexture = true;
+    resource.imported = true;
+    resource.texture = desc;
+    resource.image = image;
+    resource.imageView = imageView;
+    resource.initialLayout = initialLayout;
+    resource.finalLayout = finalLayout;
+    addResource(resource);
+}
+
+void RenderGraph::importBuffer(const std::string &name, const Buffer &buffer, const RenderGraphBufferDesc &desc) {
+    Resource resource;
+    resource.name = name;
+    resource.isTexture = false;
+    resource.imported = true;
+    resource.buffer = desc;
+    resource.bufferHandle = buffer;
+    addResource(resource);
+}
+
+void RenderGraph::addPass(const std::string &name, const SetupFunction &setup, const ExecuteFunction &execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.emplace_back(std::move(pass));
+    RenderGraphBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+    setup(builder);
+}
+
+void RenderGraph::compile() {
+    cullPasses();
+    computeLifetimes();
+    size_t key = hashTransientResources();
+    if (key != m_physical.key) {
+        releasePhysicalResources();
+        m_physical.key = key;
+        createPhysicalResources();
+        if (VK_PRINT_RENDER_GRAPH) {
+            LOG_INFO("Render graph rebuilt\n{}\n{}", dumpJson(), dumpGraphviz());
+        }
+    }
+    for (auto &resource: m_resources) {
+        if (resource.imported || resource.firstPass < 0) {
+            continue;
+        }
+        // Resources are declared again every frame, the aliasing barriers need the block they were placed in
+        auto placement = m_physical.placements.find(resource.name);
+        if (placement != m_physical.placements.end()) {
+            resource.block = placement->second.block;
+            resource.size = placement->second.size;
+        }
+        if (resource.isTexture) {
+            resource.image = m_physical.images[resource.name];
+            resource.imageView = m_physical.imageViews[resource.name];
+        } else {
+            resource.bufferHandle = m_physical.buffers[resource.name];
+        }
+    }
+    computeReleases();
+}
+
+void RenderGraph::cullPasses() {
+    // Reference counting: a pass is live while something reads what it writes or it writes an imported resource
+    for (auto &resource: m_resources) {
+        resource.readCount = 0;
+    }
+    for (auto &pass: m_passes) {
+        pass.writeCount = 0;
+        pass.culled = false;
+        for (const auto &access: pass.accesses) {
+            if (access.write) {
+                ++pass.writeCount;
+            } else {
+                ++m_resources[access.resource].readCount;
+            }
+        }
+    }
+
+    std::vector<uint32_t> unreferenced;
+    auto cullPass = [&](Pass &pass) {
+        pass.culled = true;
+        for (const auto &access: pass.accesses) {
+            Resource &resource = m_resources[access.resource];
+            if (!access.write && --resource.readCount == 0 && !resource.imported) {
+                unreferenced.emplace_back(access.resource);
+            }
+        }
+    };
+
+    for (auto &pass: m_passes) {
+        if (pass.writeCount == 0 && !pass.sideEffect) {
+            cullPass(pass);
+        }
+    }
+    for (uint32_t i = 0; i < m_resources.size(); ++i) {
+        if (m_resources[i].readCount == 0 && !m_resources[i].imported) {
+            unreferenced.emplace_back(i);
+        }
+    }
+    while (!unreferenced.empty()) {
+        uint32_t resource = unreferenced.back();
+        unreferenced.pop_back();
+        for (auto &pass: m_passes) {
+            if (pass.culled) {
+                continue;
+            }
+            for (const auto &access: pass.accesses) {
+                if (access.write && access.resource == resource && --pass.writeCount == 0 && !pass.sideEffect) {
+                    cullPass(pass);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes() {
+    for (auto &resource: m_resources) {
+        resource.firstPass = -1;
+        resource.lastPass = -1;
+        resource.imageUsage = resource.texture.usage;
+        resource.bufferUsage = resource.buffer.usage;
+    }
+    for (int i = 0; i < m_passes.size(); ++i) {
+        if (m_passes[i].culled) {
+            continue;
+        }
+        for (const auto &access: m_passes[i].accesses) {
+            Resource &resource = m_resources[access.resource];
+            if (resource.firstPass < 0) {
+                resource.firstPass = i;
+            }
+            resource.lastPass = i;
+            AccessInfo info = getAccessInfo(access.access, access.write);
+            resource.imageUsage |= info.imageUsage;
+            resource.bufferUsage |= info.bufferUsage;
+        }
+    }
+}
+
+size_t RenderGraph::hashTransientResources() const {
+    size_t hash = 0;
+    for (const auto &resource: m_resources) {
+        if (resource.imported || resource.firstPass < 0) {
+            continue;
+        }
+        hashCombine(hash, resource.name);
+        hashCombine(hash, resource.isTexture);
+        hashCombine(hash, resource.firstPass);
+        hashCombine(hash, resource.lastPass);
+        if (resource.isTexture) {
+            hashCombine(hash, resource.texture.extent.width);
+            hashCombine(hash, resource.texture.extent.height);
+            hashCombine(hash, static_cast<uint32_t>(resource.texture.format));
+            hashCombine(hash, static_cast<uint32_t>(resource.imageUsage));
+        } else {
+            hashCombine(hash, resource.buffer.size);
+            hashCombine(hash, static_cast<uint32_t>(resource.bufferUsage));
+        }
+    }
+    return hash;
+}
+
+void RenderGraph::createPhysicalResources() {
+    std::vector<uint32_t> transient;
+    std::vector<MemoryRequirements> requirements(m_resources.size());
+    for (uint32_t i = 0; i < m_resources.size(); ++i) {
+        Resource &resource = m_resources[i];
+        if (resource.imported || resource.firstPass < 0) {
+            continue;
+        }
+        try {
+            if (resource.isTexture) {
+                ImageCreateInfo imageInfo;
+                imageInfo.imageType = ImageType::e2D;
+                imageInfo.format = resource.texture.format;
+                imageInfo.extent = Extent3D(resource.texture.extent, 1);
+                imageInfo.mipLevels = 1;
+                imageInfo.arrayLayers = 1;
+                imageInfo.samples = SampleCountFlagBits::e1;
+                imageInfo.tiling = ImageTiling::eOptimal;
+                imageInfo.usage = resource.imageUsage;
+                imageInfo.sharingMode = SharingMode::eExclusive;
+                imageInfo.initialLayout = ImageLayout::eUndefined;
+                resource.image = m_device.createImage(imageInfo);
+                requirements[i] = m_device.getImageMemoryRequirements(resource.image);
+                m_physical.images[resource.name] = resource.image;
+            } else {
+                BufferCreateInfo bufferInfo;
+                bufferInfo.size = resource.buffer.size;
+                bufferInfo.usage = resource.bufferUsage;
+                bufferInfo.sharingMode = SharingMode::eExclusive;
+                resource.bufferHandle = m_device.createBuffer(bufferInfo);
+                requirements[i] = m_device.getBufferMemoryRequirements(resource.bufferHandle);
+                m_physical.buffers[resource.name] = resource.bufferHandle;
+            }
+        } catch (const SystemError &err) {
+            if (m_debug) {
+                LOG_ERROR("Failed to create render graph resource \"{}\"\n{}", resource.name, err.what());
+            }
+            continue;
+        }
+        resource.size = requirements[i].size;
+        transient.emplace_back(i);
+    }
+
+    // Largest resources first, each goes into the first block whose occupants are all dead or not yet alive
+    std::sort(transient.begin(), transient.end(), [&](uint32_t a, uint32_t b) {
+        return requirements[a].size > requirements[b].size;
+    });
+    struct Block {
+        DeviceSize size = 0;
+        uint32_t typeBits = UINT32_MAX;
+        std::vector<uint32_t> occupants;
+    };
+    std::vector<Block> blocks;
+    for (uint32_t id: transient) {
+        Resource &resource = m_resources[id];
+        for (int b = 0; b < blocks.size() && resource.block < 0; ++b) {
+            Block &block = blocks[b];
+            if ((block.typeBits & requirements[id].memoryTypeBits) == 0) {
+                continue;
+            }
+            bool overlaps = std::any_of(block.occupants.begin(), block.occupants.end(), [&](uint32_t other) {
+                return resource.firstPass <= m_resources[other].lastPass &&
+                       m_resources[other].firstPass <= resource.lastPass;
+            });
+            if (!overlaps) {
+                resource.block = b;
+            }
+        }
+        if (resource.block < 0) {
+            resource.block = static_cast<int>(blocks.size());
+            blocks.emplace_back();
+        }
+        Block &block = blocks[resource.block];
+        block.size = std::max(block.size, requirements[id].size);
+        block.typeBits &= requirements[id].memoryTypeBits;
+        block.occupants.emplace_back(id);
+        m_physical.placements[resource.name] = {resource.block, resource.size};
+    }
+
+    for (const auto &block: blocks) {
+        MemoryAllocateInfo allocInfo;
+        allocInfo.allocationSize = block.size;
+        allocInfo.memoryTypeIndex = findMemoryType(m_physicalDevice, block.typeBits,
+                                                   MemoryPropertyFlagBits::eDeviceLocal);
+        DeviceMemory memory;
+        try {
+            memory = m_device.allocateMemory(allocInfo);
+        } catch (const SystemError &err) {
+            if (m_debug) {
+                LOG_ERROR("Failed to allocate render graph memory\n{}", err.what());
+            }
+        }
+        m_physical.memory.emplace_back(memory);
+        m_physical.blockSizes.emplace_back(block.size);
+        // Every occupant starts at the beginning of the block, their lifetimes never overlap
+        for (uint32_t id: block.occupants) {
+            Resource &resource = m_resources[id];
+            if (!memory) {
+                continue;
+            }
+            if (resource.isTexture) {
+                m_device.bindImageMemory(resource.image, memory, 0);
+
+                ImageViewCreateInfo viewInfo;
+                viewInfo.image = resource.image;
+                viewInfo.viewType = ImageViewType::e2D;
+                viewInfo.format = resource.texture.format;
+                viewInfo.subresourceRange = {getAspect(resource.texture.format), 0, 1, 0, 1};
+                resource.imageView = m_device.createImageView(viewInfo);
+                m_physical.imageViews[resource.name] = resource.imageView;
+            } else {
+                m_device.bindBufferMemory(resource.bufferHandle, memory, 0);
+            }
+        }
+    }
+}
+
+void RenderGraph::releasePhysicalResources() {
+    if (m_physical.memory.empty() && m_physical.images.empty() && m_physical.buffers.empty()) {
+        return;
+    }
+    PhysicalResources retired = std::move(m_physical);
+    m_physical = PhysicalResources();
+    for (const auto &image: retired.images) {
+        m_stateTracker->removeImage(image.second);
+    }
+    for (const auto &buffer: retired.buffers) {
+        m_stateTracker->removeBuffer(buffer.second);
+    }
+    // Frames up to the previous one may still use them
+    Device device = m_device;
+    m_deletionQueue->push(m_frame - 1, [device, retired]() {
+        for (const auto &view: retired.imageViews) {
+            device.destroyImageView(view.second);
+        }
+        for (const auto &image: retired.images) {
+            device.destroyImage(image.second);
+        }
+        for (const auto &buffer: retired.buffers) {
+            device.destroyBuffer(buffer.second);
+        }
+        for (const auto &memory: retired.memory) {
+            device.freeMemory(memory);
+        }
+    });
+}
+
+void RenderGraph::computeReleases() {
+    // A transition started right after the producer overlaps with the passes until the consumer
+    std::vector<int> lastPass(m_resources.size(), -1);
+    for (auto &pass: m_passes) {
+        pass.releases.clear();
+    }
+    for (int p = 0; p < m_passes.size(); ++p) {
+        if (m_passes[p].culled) {
+            continue;
+        }
+        for (const auto &access: m_passes[p].accesses) {
+            int previous = lastPass[access.resource];
+            if (previous >= 0 && previous < p - 1) {
+                m_passes[previous].releases.emplace_back(access);
+            }
+        }
+        for (const auto &access: m_passes[p].accesses) {
+            lastPass[access.resource] = p;
+        }
+    }
+}
+
+void RenderGraph::setPipelineStatistics(PipelineStatistics *statistics) {
+    m_statistics = statistics;
+}
+
+ResourceState RenderGraph::getState(const Access &access) const {
+    AccessInfo info = getAccessInfo(access.access, access.write);
+    return {info.stages, info.access, info.layout};
+}
+
+void RenderGraph::execute(const CommandBuffer &commandBuffer) const {
+    for (const auto &resource: m_resources) {
+        if (!resource.imported) {
+            continue;
+        }
+        // Whatever ran before the graph is unknown, e.g. the semaphore wait on an acquired image
+        if (resource.isTexture) {
+            AccessFlags2 access = resource.initialLayout == ImageLayout::eUndefined ? AccessFlags2()
+                                                                                     : AccessFlagBits2::eMemoryWrite;
+            m_stateTracker->setImageState(resource.image, getAspect(resource.texture.format),
+                                          {PipelineStageFlagBits2::eAllCommands, access, resource.initialLayout});
+        } else {
+            m_stateTracker->setBufferState(resource.bufferHandle,
+                                           {PipelineStageFlagBits2::eAllCommands, AccessFlagBits2::eMemoryWrite});
+        }
+    }
+
+    // Memory shared by aliased resources hands its last use over to the next occupant
+    std::vector<ResourceState> blockStates(m_physical.memory.size());
+    for (int p = 0; p < m_passes.size(); ++p) {
+        const Pass &pass = m_passes[p];
+        if (pass.culled) {
+            continue;
+        }
+        for (const auto &access: pass.accesses) {
+            const Resource &resource = m_resources[access.resource];
+            bool firstOccupantUse = !resource.imported && resource.block >= 0 && p == resource.firstPass;
+            if (resource.isTexture) {
+                if (firstOccupantUse) {
+                    m_stateTracker->setImageState(resource.image, getAspect(resource.texture.format),
+                                                  blockStates[resource.block]);
+                }
+                m_stateTracker->useImage(resource.image, getState(access));
+            } else {
+                if (firstOccupantUse) {
+                    m_stateTracker->setBufferState(resource.bufferHandle, blockStates[resource.block]);
+                }
+                m_stateTracker->useBuffer(resource.bufferHandle, getState(access));
+            }
+        }
+        m_stateTracker->flush(commandBuffer);
+
+        {
+            GPU_ZONE(commandBuffer, pass.name.c_str());
+            uint32_t query = m_statistics ? m_statistics->begin(commandBuffer, pass.name) : 0;
+            pass.execute(commandBuffer);
+            if (m_statistics) {
+                m_statistics->end(commandBuffer, query);
+            }
+        }
+
+        for (const auto &access: pass.accesses) {
+            const Resource &resource = m_resources[access.resource];
+            if (resource.imported || resource.block < 0 || p != resource.lastPass) {
+                continue;
+            }
+            ResourceState state = resource.isTexture ? m_stateTracker->getImageState(resource.image)
+                                                     : m_stateTracker->getBufferState(resource.bufferHandle);
+            state.layout = ImageLayout::eUndefined;
+            blockStates[resource.block] = state;
+        }
+        for (const auto &release: pass.releases) {
+            const Resource &resource = m_resources[release.resource];
+            if (resource.isTexture) {
+                m_stateTracker->releaseImage(resource.image, getState(release));
+            } else {
+                m_stateTracker->releaseBuffer(resource.bufferHandle, getState(release));
+            }
+        }
+    }
+
+    for (const auto &resource: m_resources) {
+        if (resource.imported && resource.isTexture && resource.finalLayout != ImageLayout::eUndefined) {
+            m_stateTracker->useImage(resource.image, {PipelineStageFlags2(), AccessFlags2(), resource.finalLayout});
+        }
+    }
+    m_stateTracker->flush(commandBuffer);
+}
+
+Image RenderGraph::getImage(const std::string &name) const {
+    uint32_t id = findResource(name);
+    return id == UINT32_MAX ? Image() : m_resources[id].image;
+}
+
+ImageView RenderGraph::getImageView(const std::string &name) const {
+    uint32_t id = findResource(name);
+    return id == UINT32_MAX ? ImageView() : m_resources[id].imageView;
+}
+
+Buffer RenderGraph::getBuffer(const std::string &name) const {
+    uint32_t id = findResource(name);
+    return id == UINT32_MAX ? Buffer() : m_resources[id].bufferHandle;
+}
+
+DeviceSize RenderGraph::getTransientSize() const {
+    DeviceSize size = 0;
+    for (const auto &resource: m_resources) {
+        if (!resource.imported && resource.firstPass >= 0) {
+            size += resource.size;
+        }
+    }
+    return size;
+}
+
+DeviceSize RenderGraph::getAllocatedSize() const {
+    DeviceSize size = 0;
+    for (DeviceSize blockSize: m_physical.blockSizes) {
+        size += blockSize;
+    }
+    return size;
+}
+
+std::string RenderGraph::dumpGraphviz() const {
+    std::ostringstream dot;
+    dot << "digraph RenderGraph {\n\trankdir=LR;\n";
+    for (int i = 0; i < m_passes.size(); ++i) {
+        const Pass &pass = m_passes[i];
+        dot << "\tpass" << i << " [shape=box, label=\"" << pass.name << "\"";
+        if (pass.culled) {
+            dot << ", style=dashed";
+        }
+        dot << "];\n";
+    }
+    for (int i = 0; i < m_resources.size(); ++i) {
+        const Resource &resource = m_resources[i];
+        dot << "\tresource" << i << " [shape=ellipse, label=\"" << resource.name;
+        if (resource.imported) {
+            dot << "\\nimported";
+        } else {
+            dot << "\\n" << resource.size / 1024 << " KiB, block " << resource.block;
+        }
+        dot << "\"];\n";
+    }
+    for (int i = 0; i < m_passes.size(); ++i) {
+        for (const auto &access: m_passes[i].accesses) {
+            if (access.write) {
+                dot << "\tpass" << i << " -> resource" << access.resource << " [color=red];\n";
+            } else {
+                dot << "\tresource" << access.resource << " -> pass" << i << ";\n";
+            }
+        }
+    }
+    dot << "}";
+    return dot.str();
+}
+
+std::string RenderGraph::dumpJson() const {
+    std::ostringstream json;
+    json << "{\n  \"passes\": [";
+    for (int i = 0; i < m_passes.size(); ++i) {
+        const Pass &pass = m_passes[i];
+        json << (i ? "," : "") << "\n    {\"name\": \"" << pass.name << "\", \"culled\": "
+             << (pass.culled ? "true" : "false") << ", \"releases\": " << pass.releases.size()
+             << ", \"reads\": [";
+        bool first = true;
+        for (const auto &access: pass.accesses) {
+            if (!access.write) {
+                json << (first ? "" : ", ") << "\"" << m_resources[access.resource].name << "\"";
+                first = false;
+            }
+        }
+        json << "], \"writes\": [";
+        first = true;
+        for (const auto &access: pass.accesses) {
+            if (access.write) {
+                json << (first ? "" : ", ") << "\"" << m_resources[access.resource].name << "\"";
+                first = false;
+            }
+        }
+        json << "]}";
+    }
+    json << "\n  ],\n  \"resources\": [";
+    for (int i = 0; i < m_resources.size(); ++i) {
+        const Resource &resource = m_resources[i];
+        json << (i ? "," : "") << "\n    {\"name\": \"" << resource.name << "\", \"type\": \""
+             << (resource.isTexture ? "texture" : "buffer") << "\", \"imported\": "
+             << (resource.imported ? "true" : "false") << ", \"size\": " << resource.size
+             << ", \"firstPass\": " << resource.firstPass << ", \"lastPass\": " << resource.lastPass
+             << ", \"block\": " << resource.block << "}";
+    }
+    json << "\n  ],\n  \"memory\": {\"transient\": " << getTransientSize() << ", \"allocated\": "
+         << getAllocatedSize() << ", \"blocks\": " << m_physical.blockSizes.size() << "}\n}";
+    return json.str();
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <array>
+
+#include "Nest/Renderer/Vulkan/RenderQueue.hpp"
+#include "Nest/Jobs/JobSystem.hpp"
+
+static constexpr uint32_t depthBits = 27;
+static constexpr uint32_t pipelineBits = 12;
+static constexpr uint32_t materialBits = 20;
+
+uint64_t makeSortKey(uint32_t pass, uint32_t pipeline, uint32_t material, float depth, bool translucent) {
+    constexpr uint64_t depthMax = (1ull << depthBits) - 1;
+    uint64_t depthBucket = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(depthMax));
+    uint64_t passField = static_cast<uint64_t>(pass & 0xF) << 60;
+    uint64_t pipelineField = pipeline & ((1u << pipelineBits) - 1);
+    uint64_t materialField = material & ((1u << materialBits) - 1);
+    if (translucent) {
+        return passField | (1ull << 59) | ((depthMax - depthBucket) << 32) | (pipelineField << materialBits) |
+               materialField;
+    }
+    return passField | (pipelineField << (materialBits + depthBits)) | (materialField << depthBits) | depthBucket;
+}
+
+void RenderQueue::clear() {
+    m_items.clear();
+}
+
+void RenderQueue::push(uint64_t key, uint32_t drawIndex) {
+    m_items.push_back({key, drawIndex});
+}
+
+void RenderQueue::sort() {
+    auto count = static_cast<uint32_t>(m_items.size());
+    if (count < 2) {
+        return;
+    }
+    m_scratch.resize(count);
+    uint32_t jobCount = std::clamp((count + minItemsPerSortJob - 1) / minItemsPerSortJob, 1u,
+                                   JobSystem::getThreadCount());
+    std::vector<std::array<uint32_t, 256>> offsets(jobCount);
+
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        // Every job counts the digits of its own chunk
+        JobSystem::parallelFor(jobCount, [&](uint32_t job, uint32_t) {
+            std::array<uint32_t, 256> &histogram = offsets[job];
+            histogram.fill(0);
+            for (uint32_t i = count * job / jobCount; i < count * (job + 1) / jobCount; ++i) {
+                ++histogram[(m_items[i].key >> shift) & 0xFF];
+            }
+        });
+
+        // Chunk j of digit d starts after all smaller digits and after chunks before j of digit d
+        uint32_t offset = 0;
+        bool sharedDigit = false;
+        for (uint32_t digit = 0; digit < 256; ++digit) {
+            uint32_t digitCount = 0;
+            for (uint32_t job = 0; job < jobCount; ++job) {
+                uint32_t jobCountOfDigit = offsets[job][digit];
+                offsets[job][digit] = offset;
+                offset += jobCountOfDigit;
+                digitCount += jobCountOfDigit;
+            }
+            sharedDigit = sharedDigit || digitCount == count;
+        }
+        if (sharedDigit) {
+            continue;
+        }
+
+        JobSystem::parallelFor(jobCount, [&](uint32_t job, uint32_t) {
+            std::array<uint32_t, 256> &next = offsets[job];
+            for (uint32_t i = count * job / jobCount; i < count * (job + 1) / jobCount; ++i) {
+                m_scratch[next[(m_items[i].key >> shift) & 0xFF]++] = m_items[i];
+            }
+        });
+        m_items.swap(m_scratch);
+    }
+}
+
+const std::vector<RenderQueueItem> &RenderQueue::getItems() const {
+    return m_items;
+}
+
+size_t RenderQueue::size() const {
+    return m_items.size();
+}
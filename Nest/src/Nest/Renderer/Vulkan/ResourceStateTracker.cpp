@@ -0,0 +1,341 @@
+#include <algorithm>
+
+#include "Nest/Renderer/Vulkan/ResourceStateTracker.hpp"
+#include "Nest/Renderer/Vulkan/Sync.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+static const AccessFlags2 writeAccessMask =
+        AccessFlagBits2::eShaderWrite | AccessFlagBits2::eShaderStorageWrite | AccessFlagBits2::eColorAttachmentWrite |
+        AccessFlagBits2::eDepthStencilAttachmentWrite | AccessFlagBits2::eTransferWrite |
+        AccessFlagBits2::eHostWrite | AccessFlagBits2::eMemoryWrite;
+
+static DependencyInfo makeDependencyInfo(const std::vector<ImageMemoryBarrier2> &imageBarriers,
+                                         const std::vector<BufferMemoryBarrier2> &bufferBarriers) {
+    DependencyInfo dependencyInfo;
+    dependencyInfo.imageMemoryBarrierCount = imageBarriers.size();
+    dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+    dependencyInfo.bufferMemoryBarrierCount = bufferBarriers.size();
+    dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+    return dependencyInfo;
+}
+
+void ResourceStateTracker::init(const Device &device, bool synchronization2, uint32_t framesInFlight,
+                                const DispatchLoaderDynamic &dld, bool debug) {
+    m_device = device;
+    m_synchronization2 = synchronization2;
+    m_dld = &dld;
+    m_debug = debug;
+    m_frameEvents.resize(framesInFlight);
+}
+
+void ResourceStateTracker::destroy() {
+    for (const auto &frame: m_frameEvents) {
+        for (const auto &split: frame.events) {
+            m_device.destroyEvent(split.event);
+        }
+    }
+    m_frameEvents.clear();
+    m_images.clear();
+    m_buffers.clear();
+}
+
+void ResourceStateTracker::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    FrameEvents &frame = m_frameEvents[frameIndex];
+    for (uint32_t i = 0; i < frame.used; ++i) {
+        m_device.resetEvent(frame.events[i].event);
+    }
+    frame.used = 0;
+
+    // A release nobody waited for still belongs to a frame which may be in flight, the next use waits for everything
+    ResourceState unknown = {PipelineStageFlagBits2::eAllCommands, AccessFlagBits2::eMemoryWrite};
+    for (auto &image: m_images) {
+        if (image.second.state.splitEvent >= 0) {
+            unknown.layout = image.second.state.layout;
+            resetState(image.second.state, unknown);
+        }
+    }
+    for (auto &buffer: m_buffers) {
+        if (buffer.second.splitEvent >= 0) {
+            resetState(buffer.second, unknown);
+        }
+    }
+}
+
+void ResourceStateTracker::setImageState(const Image &image, ImageAspectFlags aspect, const ResourceState &state) {
+    TrackedImage &tracked = m_images[static_cast<VkImage>(image)];
+    tracked.aspect = aspect;
+    resetState(tracked.state, state);
+}
+
+void ResourceStateTracker::setBufferState(const Buffer &buffer, const ResourceState &state) {
+    resetState(m_buffers[static_cast<VkBuffer>(buffer)], state);
+}
+
+ResourceState ResourceStateTracker::getImageState(const Image &image) const {
+    auto found = m_images.find(static_cast<VkImage>(image));
+    if (found == m_images.end()) {
+        return {};
+    }
+    const TrackedState &state = found->second.state;
+    return {state.writeStages | state.readStages, state.writeAccess, state.layout};
+}
+
+ResourceState ResourceStateTracker::getBufferState(const Buffer &buffer) const {
+    auto found = m_buffers.find(static_cast<VkBuffer>(buffer));
+    if (found == m_buffers.end()) {
+        return {};
+    }
+    const TrackedState &state = found->second;
+    return {state.writeStages | state.readStages, state.writeAccess};
+}
+
+void ResourceStateTracker::removeImage(const Image &image) {
+    m_images.erase(static_cast<VkImage>(image));
+}
+
+void ResourceStateTracker::removeBuffer(const Buffer &buffer) {
+    m_buffers.erase(static_cast<VkBuffer>(buffer));
+}
+
+void ResourceStateTracker::resetState(TrackedState &state, const ResourceState &next) {
+    state = TrackedState();
+    state.layout = next.layout;
+    state.writeStages = next.stages;
+    state.writeAccess = next.access & writeAccessMask;
+}
+
+bool ResourceStateTracker::transition(TrackedState &state, const ResourceState &next, bool isImage,
+                                      PipelineStageFlags2 &srcStages, AccessFlags2 &srcAccess) {
+    bool write = static_cast<bool>(next.access & writeAccessMask);
+    bool layoutChange = isImage && next.layout != state.layout;
+    if (write || layoutChange) {
+        // Write after read only has to wait for the reads to finish, their caches hold nothing to flush
+        srcStages = state.writeStages | state.readStages;
+        srcAccess = state.writeAccess;
+        // A layout transition acts as a write the later uses have to be ordered after
+        state.layout = next.layout;
+        state.writeStages = next.stages;
+        state.writeAccess = next.access & writeAccessMask;
+        state.readStages = PipelineStageFlags2();
+        state.visibleStages = next.stages;
+        return layoutChange || srcStages;
+    }
+    PipelineStageFlags2 missingStages = next.stages & ~state.visibleStages;
+    state.readStages |= next.stages;
+    state.visibleStages |= next.stages;
+    if (!missingStages || !state.writeStages) {
+        return false;
+    }
+    srcStages = state.writeStages;
+    srcAccess = state.writeAccess;
+    return true;
+}
+
+bool ResourceStateTracker::waitSplit(TrackedState &state, const ResourceState &next) {
+    if (state.splitEvent < 0) {
+        return false;
+    }
+    if (state.splitEvent == m_releaseEvent && m_debug) {
+        LOG_ERROR("Resource used before its release was flushed");
+    }
+    auto event = static_cast<uint32_t>(state.splitEvent);
+    if (std::find(m_waitEvents.begin(), m_waitEvents.end(), event) == m_waitEvents.end()) {
+        m_waitEvents.emplace_back(event);
+    }
+    state.splitEvent = -1;
+    const ResourceState &released = state.released;
+    return next.layout == released.layout && !(next.stages & ~released.stages) &&
+           !(next.access & ~released.access);
+}
+
+void ResourceStateTracker::useImage(const Image &image, const ResourceState &state) {
+    TrackedImage &tracked = m_images[static_cast<VkImage>(image)];
+    if (waitSplit(tracked.state, state)) {
+        return;
+    }
+    ImageLayout oldLayout = tracked.state.layout;
+    PipelineStageFlags2 srcStages;
+    AccessFlags2 srcAccess;
+    if (!transition(tracked.state, state, true, srcStages, srcAccess)) {
+        return;
+    }
+    // Uses of one pass share the barrier, they can't ask for different layouts
+    if (tracked.state.pendingBatch == m_batchId) {
+        ImageMemoryBarrier2 &barrier = m_batch.imageBarriers[tracked.state.pendingBarrier];
+        if (barrier.newLayout != state.layout && m_debug) {
+            LOG_ERROR("Image used in two layouts between two barrier flushes");
+        }
+        barrier.dstStageMask |= state.stages;
+        barrier.dstAccessMask |= state.access;
+        return;
+    }
+    ImageMemoryBarrier2 barrier;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = state.stages;
+    barrier.dstAccessMask = state.access;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = state.layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {tracked.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    tracked.state.pendingBatch = m_batchId;
+    tracked.state.pendingBarrier = m_batch.imageBarriers.size();
+    m_batch.imageBarriers.emplace_back(barrier);
+}
+
+void ResourceStateTracker::useBuffer(const Buffer &buffer, const ResourceState &state) {
+    TrackedState &tracked = m_buffers[static_cast<VkBuffer>(buffer)];
+    if (waitSplit(tracked, state)) {
+        return;
+    }
+    PipelineStageFlags2 srcStages;
+    AccessFlags2 srcAccess;
+    if (!transition(tracked, state, false, srcStages, srcAccess)) {
+        return;
+    }
+    if (tracked.pendingBatch == m_batchId) {
+        BufferMemoryBarrier2 &barrier = m_batch.bufferBarriers[tracked.pendingBarrier];
+        barrier.dstStageMask |= state.stages;
+        barrier.dstAccessMask |= state.access;
+        return;
+    }
+    BufferMemoryBarrier2 barrier;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = state.stages;
+    barrier.dstAccessMask = state.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    tracked.pendingBatch = m_batchId;
+    tracked.pendingBarrier = m_batch.bufferBarriers.size();
+    m_batch.bufferBarriers.emplace_back(barrier);
+}
+
+void ResourceStateTracker::releaseImage(const Image &image, const ResourceState &state) {
+    if (!m_synchronization2) {
+        return;
+    }
+    TrackedImage &tracked = m_images[static_cast<VkImage>(image)];
+    if (tracked.state.splitEvent >= 0) {
+        return;
+    }
+    ImageLayout oldLayout = tracked.state.layout;
+    PipelineStageFlags2 srcStages;
+    AccessFlags2 srcAccess;
+    TrackedState next = tracked.state;
+    if (!transition(next, state, true, srcStages, srcAccess)) {
+        return;
+    }
+    if (m_releaseEvent < 0) {
+        m_releaseEvent = static_cast<int>(acquireEvent());
+    }
+    ImageMemoryBarrier2 barrier;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = state.stages;
+    barrier.dstAccessMask = state.access;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = state.layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {tracked.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    m_releaseBatch.imageBarriers.emplace_back(barrier);
+    tracked.state = next;
+    tracked.state.splitEvent = m_releaseEvent;
+    tracked.state.released = state;
+}
+
+void ResourceStateTracker::releaseBuffer(const Buffer &buffer, const ResourceState &state) {
+    if (!m_synchronization2) {
+        return;
+    }
+    TrackedState &tracked = m_buffers[static_cast<VkBuffer>(buffer)];
+    if (tracked.splitEvent >= 0) {
+        return;
+    }
+    PipelineStageFlags2 srcStages;
+    AccessFlags2 srcAccess;
+    TrackedState next = tracked;
+    if (!transition(next, state, false, srcStages, srcAccess)) {
+        return;
+    }
+    if (m_releaseEvent < 0) {
+        m_releaseEvent = static_cast<int>(acquireEvent());
+    }
+    BufferMemoryBarrier2 barrier;
+    barrier.srcStageMask = srcStages;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstStageMask = state.stages;
+    barrier.dstAccessMask = state.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    m_releaseBatch.bufferBarriers.emplace_back(barrier);
+    tracked = next;
+    tracked.splitEvent = m_releaseEvent;
+    tracked.released = state;
+}
+
+uint32_t ResourceStateTracker::acquireEvent() {
+    FrameEvents &frame = m_frameEvents[m_frameIndex];
+    if (frame.used == frame.events.size()) {
+        SplitEvent split;
+        try {
+            split.event = m_device.createEvent(EventCreateInfo());
+        } catch (const SystemError &err) {
+            if (m_debug) {
+                LOG_ERROR("Failed to create event for a split barrier\n{}", err.what());
+            }
+        }
+        frame.events.emplace_back(split);
+    }
+    return frame.used++;
+}
+
+void ResourceStateTracker::recordBatch(const CommandBuffer &commandBuffer, const Batch &batch) {
+    recordBarriers(commandBuffer, batch.imageBarriers, batch.bufferBarriers, m_synchronization2, *m_dld);
+}
+
+void ResourceStateTracker::flush(const CommandBuffer &commandBuffer) {
+    FrameEvents &frame = m_frameEvents[m_frameIndex];
+    if (!m_waitEvents.empty()) {
+        std::vector<Event> events;
+        std::vector<DependencyInfo> dependencies;
+        for (uint32_t index: m_waitEvents) {
+            const SplitEvent &split = frame.events[index];
+            events.emplace_back(split.event);
+            dependencies.emplace_back(makeDependencyInfo(split.batch.imageBarriers, split.batch.bufferBarriers));
+        }
+        commandBuffer.waitEvents2(events, dependencies, *m_dld);
+        m_waitEvents.clear();
+    }
+    if (!m_batch.imageBarriers.empty() || !m_batch.bufferBarriers.empty()) {
+        recordBatch(commandBuffer, m_batch);
+        ++m_barrierCount;
+        m_batch.imageBarriers.clear();
+        m_batch.bufferBarriers.clear();
+    }
+    ++m_batchId;
+    if (m_releaseEvent >= 0) {
+        SplitEvent &split = frame.events[m_releaseEvent];
+        split.batch = std::move(m_releaseBatch);
+        m_releaseBatch = Batch();
+        commandBuffer.setEvent2(split.event, makeDependencyInfo(split.batch.imageBarriers,
+                                                                split.batch.bufferBarriers), *m_dld);
+        ++m_barrierCount;
+        m_releaseEvent = -1;
+    }
+}
+
+uint64_t ResourceStateTracker::getBarrierCount() const {
+    return m_barrierCount;
+}
@@ -0,0 +1,97 @@
+#include "Nest/Renderer/Vulkan/StaticCommandCache.hpp"
+#include "Nest/Renderer/Vulkan/Commands.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+void StaticCommandCache::init(const Device &device, uint32_t queueFamilyIndex, DeletionQueue &deletionQueue,
+                              bool debug) {
+    m_device = device;
+    m_deletionQueue = &deletionQueue;
+    m_debug = debug;
+    // Recordings are reset one at a time when their image records again
+    m_pool = makeCommandPool(device, queueFamilyIndex, CommandPoolCreateFlagBits::eResetCommandBuffer, debug);
+}
+
+void StaticCommandCache::destroy() {
+    m_entries.clear();
+    // Frees the command buffers with it
+    m_device.destroyCommandPool(m_pool);
+    m_pool = nullptr;
+}
+
+void StaticCommandCache::resize(uint32_t imageCount, uint64_t frame) {
+    std::vector<CommandBuffer> retired;
+    for (const auto &entry: m_entries) {
+        if (entry.commandBuffer) {
+            retired.emplace_back(entry.commandBuffer);
+        }
+    }
+    if (!retired.empty()) {
+        m_deletionQueue->push(frame, [device = m_device, pool = m_pool, retired]() {
+            device.freeCommandBuffers(pool, retired);
+        });
+    }
+
+    m_entries.assign(imageCount, Entry());
+    CommandBufferAllocateInfo allocInfo;
+    allocInfo.commandPool = m_pool;
+    allocInfo.level = CommandBufferLevel::eSecondary;
+    allocInfo.commandBufferCount = imageCount;
+    try {
+        std::vector<CommandBuffer> commandBuffers = m_device.allocateCommandBuffers(allocInfo);
+        for (uint32_t i = 0; i < imageCount; ++i) {
+            m_entries[i].commandBuffer = commandBuffers[i];
+        }
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to allocate static command buffers\n{}", err.what());
+        }
+    }
+}
+
+void StaticCommandCache::invalidate() {
+    ++m_version;
+}
+
+CommandBuffer StaticCommandCache::get(uint32_t imageIndex) const {
+    const Entry &entry = m_entries[imageIndex];
+    return entry.version == m_version ? entry.commandBuffer : CommandBuffer();
+}
+
+const FrameStats &StaticCommandCache::getStats(uint32_t imageIndex) const {
+    return m_entries[imageIndex].stats;
+}
+
+CommandBuffer StaticCommandCache::begin(uint32_t imageIndex, const CommandBufferInheritanceInfo &inheritanceInfo) {
+    Entry &entry = m_entries[imageIndex];
+    entry.version = 0;
+    if (!entry.commandBuffer) {
+        return nullptr;
+    }
+    // Not one time submit, the recording is executed by every frame rendering to the image
+    CommandBufferBeginInfo beginInfo;
+    beginInfo.flags = CommandBufferUsageFlagBits::eRenderPassContinue;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    try {
+        entry.commandBuffer.begin(beginInfo);
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to begin static command buffer\n{}", err.what());
+        }
+        return nullptr;
+    }
+    return entry.commandBuffer;
+}
+
+void StaticCommandCache::end(uint32_t imageIndex, const FrameStats &stats) {
+    Entry &entry = m_entries[imageIndex];
+    try {
+        entry.commandBuffer.end();
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to record static command buffer\n{}", err.what());
+        }
+        return;
+    }
+    entry.stats = stats;
+    entry.version = m_version;
+}
@@ -0,0 +1,155 @@
+#include "Nest/Renderer/Vulkan/SubmitBatcher.hpp"
+#include "Nest/Renderer/Vulkan/Sync.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+void SubmitBatcher::init(bool synchronization2, bool timelineSemaphore, const DispatchLoaderDynamic &dld,
+                         bool debug) {
+    m_synchronization2 = synchronization2;
+    m_timelineSemaphore = timelineSemaphore;
+    m_dld = &dld;
+    m_debug = debug;
+}
+
+SubmitBatcher::QueueWork &SubmitBatcher::getWork(const Queue &queue) {
+    for (auto &work: m_work) {
+        if (work.queue == queue) {
+            return work;
+        }
+    }
+    m_work.emplace_back();
+    m_work.back().queue = queue;
+    return m_work.back();
+}
+
+void SubmitBatcher::wait(const Queue &queue, const Semaphore &semaphore, PipelineStageFlags2 stages, uint64_t value) {
+    QueueWork &work = getWork(queue);
+    // Waits have to come before the command buffers of their batch
+    if (work.batches.empty() || !work.batches.back().commandBuffers.empty() || !work.batches.back().signals.empty()) {
+        work.batches.emplace_back();
+    }
+    work.batches.back().waits.emplace_back(semaphore, value, stages);
+}
+
+void SubmitBatcher::submit(const Queue &queue, const CommandBuffer &commandBuffer) {
+    QueueWork &work = getWork(queue);
+    if (work.batches.empty() || !work.batches.back().signals.empty()) {
+        work.batches.emplace_back();
+    }
+    work.batches.back().commandBuffers.emplace_back(commandBuffer);
+}
+
+void SubmitBatcher::signal(const Queue &queue, const Semaphore &semaphore, uint64_t value,
+                           PipelineStageFlags2 stages) {
+    QueueWork &work = getWork(queue);
+    if (work.batches.empty()) {
+        work.batches.emplace_back();
+    }
+    work.batches.back().signals.emplace_back(semaphore, value, stages);
+}
+
+bool SubmitBatcher::flush(const Queue &queue, const Fence &fence) {
+    QueueWork &work = getWork(queue);
+    if (work.batches.empty() && !fence) {
+        return true;
+    }
+    bool submitted = true;
+    try {
+        if (m_synchronization2) {
+            std::vector<SubmitInfo2> submits;
+            submits.reserve(work.batches.size());
+            for (const auto &batch: work.batches) {
+                SubmitInfo2 submit;
+                submit.waitSemaphoreInfoCount = batch.waits.size();
+                submit.pWaitSemaphoreInfos = batch.waits.data();
+                submit.commandBufferInfoCount = batch.commandBuffers.size();
+                submit.pCommandBufferInfos = batch.commandBuffers.data();
+                submit.signalSemaphoreInfoCount = batch.signals.size();
+                submit.pSignalSemaphoreInfos = batch.signals.data();
+                submits.emplace_back(submit);
+            }
+            queue.submit2(submits, fence, *m_dld);
+        } else {
+            submitLegacy(work, fence);
+        }
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to submit to queue\n{}", err.what());
+        }
+        submitted = false;
+    }
+    ++m_submitCount;
+    m_batchCount += work.batches.size();
+    work.batches.clear();
+    return submitted;
+}
+
+void SubmitBatcher::submitLegacy(const QueueWork &work, const Fence &fence) const {
+    struct LegacyBatch {
+        std::vector<Semaphore> waits;
+        std::vector<PipelineStageFlags> waitStages;
+        std::vector<uint64_t> waitValues;
+        std::vector<CommandBuffer> commandBuffers;
+        std::vector<Semaphore> signals;
+        std::vector<uint64_t> signalValues;
+        TimelineSemaphoreSubmitInfo timelineInfo;
+    };
+    // Sized up front, the submit infos point into the batches
+    std::vector<LegacyBatch> legacyBatches(work.batches.size());
+    std::vector<SubmitInfo> submits(work.batches.size());
+    for (size_t i = 0; i < work.batches.size(); ++i) {
+        const Batch &batch = work.batches[i];
+        LegacyBatch &legacy = legacyBatches[i];
+        for (const auto &wait: batch.waits) {
+            legacy.waits.emplace_back(wait.semaphore);
+            legacy.waitStages.emplace_back(toLegacyStages(wait.stageMask, PipelineStageFlagBits::eTopOfPipe));
+            legacy.waitValues.emplace_back(wait.value);
+        }
+        for (const auto &commandBuffer: batch.commandBuffers) {
+            legacy.commandBuffers.emplace_back(commandBuffer.commandBuffer);
+        }
+        for (const auto &signal: batch.signals) {
+            legacy.signals.emplace_back(signal.semaphore);
+            legacy.signalValues.emplace_back(signal.value);
+        }
+
+        SubmitInfo &submit = submits[i];
+        submit.waitSemaphoreCount = legacy.waits.size();
+        submit.pWaitSemaphores = legacy.waits.data();
+        submit.pWaitDstStageMask = legacy.waitStages.data();
+        submit.commandBufferCount = legacy.commandBuffers.size();
+        submit.pCommandBuffers = legacy.commandBuffers.data();
+        submit.signalSemaphoreCount = legacy.signals.size();
+        submit.pSignalSemaphores = legacy.signals.data();
+        if (m_timelineSemaphore) {
+            legacy.timelineInfo.waitSemaphoreValueCount = legacy.waitValues.size();
+            legacy.timelineInfo.pWaitSemaphoreValues = legacy.waitValues.data();
+            legacy.timelineInfo.signalSemaphoreValueCount = legacy.signalValues.size();
+            legacy.timelineInfo.pSignalSemaphoreValues = legacy.signalValues.data();
+            submit.pNext = &legacy.timelineInfo;
+        }
+    }
+    work.queue.submit(submits, fence);
+}
+
+bool SubmitBatcher::flushAll() {
+    bool submitted = true;
+    for (auto &work: m_work) {
+        if (!work.batches.empty()) {
+            submitted = flush(work.queue) && submitted;
+        }
+    }
+    return submitted;
+}
+
+uint32_t SubmitBatcher::getSubmitCount() const {
+    return m_submitCount;
+}
+
+uint32_t SubmitBatcher::getBatchCount() const {
+    return m_batchCount;
+}
+
+void SubmitBatcher::resetStats() {
+    m_submitCount = 0;
+    m_batchCount = 0;
+}
@@ -86,10 +86,9 @@ SurfaceFormatKHR chooseSwapchainSurfaceFormat(const std::vector<SurfaceFormatKHR
     return formats[0];
 }
 
-PresentModeKHR chooseSwapchainPresentMode(const std::vector<PresentModeKHR> &presentModes) {
+PresentModeKHR chooseSwapchainPresentMode(const std::vector<PresentModeKHR> &presentModes, PresentModeKHR requested) {
     for (const auto &presentMode: presentModes) {
-        // rendering mode
-        if (presentMode == PresentModeKHR::eMailbox) {
+        if (presentMode == requested) {
             return presentMode;
         }
     }
@@ -119,12 +118,12 @@ chooseSwapchainExtent(uint32_t width, uint32_t height, const SurfaceCapabilities
 
 SwapChainBundle
 createSwapchain(Device logicalDevice, PhysicalDevice physicalDevice, SurfaceKHR surface, int width,
-                int height, SwapchainKHR *oldSwapchain) {
+                int height, PresentModeKHR requestedPresentMode, SwapchainKHR *oldSwapchain) {
     SwapChainSupportDetails support = querySwapchainSupport(physicalDevice, surface);
 
     SurfaceFormatKHR format = chooseSwapchainSurfaceFormat(support.formats);
 
-    PresentModeKHR presentMode = chooseSwapchainPresentMode(support.presentModes);
+    PresentModeKHR presentMode = chooseSwapchainPresentMode(support.presentModes, requestedPresentMode);
 
     Extent2D extent = chooseSwapchainExtent(width, height, support.capabilities);
 
@@ -170,6 +169,7 @@ createSwapchain(Device logicalDevice, PhysicalDevice physicalDevice, SurfaceKHR
     }
 
     SwapChainBundle bundle{};
+    bundle.presentMode = presentMode;
     try {
         bundle.swapchain = logicalDevice.createSwapchainKHR(createInfo);
     } catch (const SystemError &err) {
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "Nest/Renderer/Vulkan/Sync.hpp"
 #include "Nest/Logger/Logger.hpp"
 
@@ -27,4 +29,110 @@ Fence makeFence(const Device &device, bool debug) {
         }
         return nullptr;
     }
+}
+
+PipelineStageFlags toLegacyStages(PipelineStageFlags2 stages, PipelineStageFlagBits empty) {
+    // The synchronization2 bits below 32 have the same meaning as the original ones
+    auto legacy = static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(stages) & 0xFFFFFFFFu);
+    if (static_cast<VkPipelineStageFlags2>(stages) >> 32) {
+        legacy |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
+    return legacy ? PipelineStageFlags(legacy) : PipelineStageFlags(empty);
+}
+
+AccessFlags toLegacyAccess(AccessFlags2 access) {
+    VkAccessFlags2 bits = static_cast<VkAccessFlags2>(access);
+    auto legacy = static_cast<VkAccessFlags>(bits & 0xFFFFFFFFu);
+    if (access & (AccessFlagBits2::eShaderSampledRead | AccessFlagBits2::eShaderStorageRead)) {
+        legacy |= VK_ACCESS_SHADER_READ_BIT;
+    }
+    if (access & AccessFlagBits2::eShaderStorageWrite) {
+        legacy |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    return AccessFlags(legacy);
+}
+
+void recordBarriers(const CommandBuffer &commandBuffer, const std::vector<ImageMemoryBarrier2> &imageBarriers,
+                    const std::vector<BufferMemoryBarrier2> &bufferBarriers, bool synchronization2,
+                    const DispatchLoaderDynamic &dld) {
+    if (synchronization2) {
+        DependencyInfo dependencyInfo;
+        dependencyInfo.imageMemoryBarrierCount = imageBarriers.size();
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+        dependencyInfo.bufferMemoryBarrierCount = bufferBarriers.size();
+        dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+        commandBuffer.pipelineBarrier2(dependencyInfo, dld);
+        return;
+    }
+    PipelineStageFlags srcStages;
+    PipelineStageFlags dstStages;
+    std::vector<ImageMemoryBarrier> legacyImageBarriers;
+    std::vector<BufferMemoryBarrier> legacyBufferBarriers;
+    for (const auto &barrier: imageBarriers) {
+        srcStages |= toLegacyStages(barrier.srcStageMask, PipelineStageFlagBits::eTopOfPipe);
+        dstStages |= toLegacyStages(barrier.dstStageMask, PipelineStageFlagBits::eBottomOfPipe);
+        ImageMemoryBarrier legacy;
+        legacy.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        legacyImageBarriers.emplace_back(legacy);
+    }
+    for (const auto &barrier: bufferBarriers) {
+        srcStages |= toLegacyStages(barrier.srcStageMask, PipelineStageFlagBits::eTopOfPipe);
+        dstStages |= toLegacyStages(barrier.dstStageMask, PipelineStageFlagBits::eBottomOfPipe);
+        BufferMemoryBarrier legacy;
+        legacy.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        legacyBufferBarriers.emplace_back(legacy);
+    }
+    commandBuffer.pipelineBarrier(srcStages, dstStages, DependencyFlags(), nullptr, legacyBufferBarriers,
+                                  legacyImageBarriers);
+}
+
+Semaphore makeTimelineSemaphore(const Device &device, uint64_t initialValue, bool debug) {
+    SemaphoreTypeCreateInfo typeInfo;
+    typeInfo.semaphoreType = SemaphoreType::eTimeline;
+    typeInfo.initialValue = initialValue;
+
+    SemaphoreCreateInfo semaphoreInfo;
+    semaphoreInfo.flags = SemaphoreCreateFlags();
+    semaphoreInfo.pNext = &typeInfo;
+
+    try {
+        return device.createSemaphore(semaphoreInfo);
+    } catch (const SystemError &err) {
+        if (debug) {
+            LOG_ERROR("Failed to create timeline semaphore\n{}", err.what());
+        }
+        return nullptr;
+    }
+}
+
+uint64_t pollTimeline(const Device &device, QueueTimeline &timeline, const DispatchLoaderDynamic &dld) {
+    timeline.completedValue = std::max(timeline.completedValue,
+                                       device.getSemaphoreCounterValue(timeline.semaphore, dld));
+    return timeline.completedValue;
+}
+
+void waitTimeline(const Device &device, QueueTimeline &timeline, uint64_t value, const DispatchLoaderDynamic &dld) {
+    if (timeline.completedValue >= value) {
+        return;
+    }
+    SemaphoreWaitInfo waitInfo;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline.semaphore;
+    waitInfo.pValues = &value;
+    if (device.waitSemaphores(waitInfo, UINT64_MAX, dld) == Result::eSuccess) {
+        timeline.completedValue = value;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include <cstring>
+
+#include "Nest/Renderer/Vulkan/UploadQueue.hpp"
+#include "Nest/Renderer/Vulkan/Commands.hpp"
+#include "Nest/Renderer/Vulkan/Sync.hpp"
+#include "Nest/Logger/Logger.hpp"
+
+void UploadQueue::init(const Device &device, const PhysicalDevice &physicalDevice, const QueueFamilyIndices &indices,
+                       const Queue &transferQueue, bool timelineSemaphore, bool synchronization2,
+                       const DispatchLoaderDynamic &dld, bool debug) {
+    m_device = device;
+    m_physicalDevice = physicalDevice;
+    m_graphicsFamily = indices.graphicsFamily.value();
+    // Other queues signal the graphics side through the timeline, there is no fallback for binary semaphores
+    m_dedicated = static_cast<bool>(transferQueue) && timelineSemaphore;
+    m_transferQueue = transferQueue;
+    m_uploadFamily = m_dedicated ? indices.transferFamily.value() : m_graphicsFamily;
+    m_synchronization2 = synchronization2;
+    m_dld = &dld;
+    m_debug = debug;
+    if (m_dedicated) {
+        m_timeline = makeTimelineSemaphore(device, 0, debug);
+    }
+    if (debug) {
+        LOG_INFO(m_dedicated ? "Uploads use the transfer queue" : "Uploads use the graphics queue");
+    }
+}
+
+void UploadQueue::destroy() {
+    for (auto &[id, uploader]: m_threads) {
+        for (auto &pending: uploader.pending) {
+            destroyBuffer(m_device, pending.staging);
+        }
+        m_device.destroyCommandPool(uploader.pool);
+    }
+    m_threads.clear();
+    m_device.destroySemaphore(m_timeline);
+}
+
+bool UploadQueue::isDedicated() const {
+    return m_dedicated;
+}
+
+UploadQueue::ThreadUploader &UploadQueue::getThreadUploader() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [it, inserted] = m_threads.try_emplace(std::this_thread::get_id());
+    if (inserted) {
+        it->second.pool = makeCommandPool(m_device, m_uploadFamily, CommandPoolCreateFlagBits::eTransient, m_debug);
+    }
+    // Map nodes never move, the reference stays valid after the lock is released
+    return it->second;
+}
+
+bool UploadQueue::isComplete(uint64_t upload) const {
+    if (m_dedicated) {
+        return m_device.getSemaphoreCounterValue(m_timeline, *m_dld) >= upload;
+    }
+    return m_completedUpload.load(std::memory_order_acquire) >= upload;
+}
+
+template<typename Record>
+uint64_t UploadQueue::upload(const void *data, DeviceSize size, Record &&record) {
+    ThreadUploader &uploader = getThreadUploader();
+    // Recycle what earlier uploads of this thread left behind
+    std::erase_if(uploader.pending, [this, &uploader](PendingUpload &pending) {
+        if (!isComplete(pending.upload)) {
+            return false;
+        }
+        m_device.freeCommandBuffers(uploader.pool, pending.commandBuffer);
+        destroyBuffer(m_device, pending.staging);
+        return true;
+    });
+
+    PendingUpload pending;
+    pending.staging = makeBuffer(m_device, m_physicalDevice, size, BufferUsageFlagBits::eTransferSrc,
+                                 MemoryPropertyFlagBits::eHostVisible | MemoryPropertyFlagBits::eHostCoherent,
+                                 m_debug);
+    if (!pending.staging.mapped) {
+        return 0;
+    }
+    std::memcpy(pending.staging.mapped, data, size);
+    Acquires acquires;
+
+    CommandBufferAllocateInfo allocInfo;
+    allocInfo.commandPool = uploader.pool;
+    allocInfo.level = CommandBufferLevel::ePrimary;
+    allocInfo.commandBufferCount = 1;
+    try {
+        pending.commandBuffer = m_device.allocateCommandBuffers(allocInfo)[0];
+        CommandBufferBeginInfo beginInfo;
+        beginInfo.flags = CommandBufferUsageFlagBits::eOneTimeSubmit;
+        pending.commandBuffer.begin(beginInfo);
+        record(pending.commandBuffer, pending.staging.buffer, acquires);
+        pending.commandBuffer.end();
+    } catch (const SystemError &err) {
+        if (m_debug) {
+            LOG_ERROR("Failed to record upload\n{}", err.what());
+        }
+        destroyBuffer(m_device, pending.staging);
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.upload = ++m_submittedUpload;
+        if (m_dedicated) {
+            // Numbers are taken under the lock, so the timeline is signaled in increasing order
+            TimelineSemaphoreSubmitInfo timelineInfo;
+            timelineInfo.signalSemaphoreValueCount = 1;
+            timelineInfo.pSignalSemaphoreValues = &pending.upload;
+            SubmitInfo submitInfo;
+            submitInfo.pNext = &timelineInfo;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &pending.commandBuffer;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &m_timeline;
+            try {
+                m_transferQueue.submit(submitInfo);
+            } catch (const SystemError &err) {
+                if (m_debug) {
+                    LOG_ERROR("Failed to submit upload\n{}", err.what());
+                }
+            }
+            // Only submitted uploads may be acquired, the frame waits for the number the acquire belongs to
+            m_acquires.buffers.insert(m_acquires.buffers.end(), acquires.buffers.begin(), acquires.buffers.end());
+            m_acquires.images.insert(m_acquires.images.end(), acquires.images.begin(), acquires.images.end());
+        } else {
+            m_pendingSubmits.emplace_back(pending.commandBuffer);
+        }
+    }
+    uint64_t number = pending.upload;
+    uploader.pending.emplace_back(pending);
+    return number;
+}
+
+void UploadQueue::recordTransfer(const CommandBuffer &commandBuffer, const BufferMemoryBarrier2 *bufferBarrier,
+                                 const ImageMemoryBarrier2 *imageBarrier, Acquires &acquires) const {
+    std::vector<BufferMemoryBarrier2> bufferBarriers;
+    std::vector<ImageMemoryBarrier2> imageBarriers;
+    if (bufferBarrier) {
+        bufferBarriers.emplace_back(*bufferBarrier);
+    }
+    if (imageBarrier) {
+        imageBarriers.emplace_back(*imageBarrier);
+    }
+    if (!m_dedicated) {
+        // Same queue as the frame, an ordinary barrier after the copy is enough
+        recordBarriers(commandBuffer, imageBarriers, bufferBarriers, m_synchronization2, *m_dld);
+        return;
+    }
+    // The release only has the source half, the acquire recorded by the frame the destination half
+    for (auto &barrier: bufferBarriers) {
+        barrier.srcQueueFamilyIndex = m_uploadFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        BufferMemoryBarrier2 acquire = barrier;
+        acquire.srcStageMask = PipelineStageFlags2();
+        acquire.srcAccessMask = AccessFlags2();
+        barrier.dstStageMask = PipelineStageFlags2();
+        barrier.dstAccessMask = AccessFlags2();
+        acquires.buffers.emplace_back(acquire);
+    }
+    for (auto &barrier: imageBarriers) {
+        barrier.srcQueueFamilyIndex = m_uploadFamily;
+        barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        ImageMemoryBarrier2 acquire = barrier;
+        acquire.srcStageMask = PipelineStageFlags2();
+        acquire.srcAccessMask = AccessFlags2();
+        barrier.dstStageMask = PipelineStageFlags2();
+        barrier.dstAccessMask = AccessFlags2();
+        acquires.images.emplace_back(acquire);
+    }
+    recordBarriers(commandBuffer, imageBarriers, bufferBarriers, m_synchronization2, *m_dld);
+}
+
+uint64_t UploadQueue::uploadBuffer(const Buffer &buffer, DeviceSize offset, const void *data, DeviceSize size,
+                                   PipelineStageFlags2 dstStages, AccessFlags2 dstAccess) {
+    return upload(data, size, [&](const CommandBuffer &commandBuffer, const Buffer &staging, Acquires &acquires) {
+        commandBuffer.copyBuffer(staging, buffer, BufferCopy(0, offset, size));
+
+        BufferMemoryBarrier2 barrier;
+        barrier.srcStageMask = PipelineStageFlagBits2::eTransfer;
+        barrier.srcAccessMask = AccessFlagBits2::eTransferWrite;
+        barrier.dstStageMask = dstStages;
+        barrier.dstAccessMask = dstAccess;
+        barrier.buffer = buffer;
+        barrier.offset = offset;
+        barrier.size = size;
+        recordTransfer(commandBuffer, &barrier, nullptr, acquires);
+    });
+}
+
+uint64_t UploadQueue::uploadImage(const Image &image, const Extent3D &extent, const void *data, DeviceSize size,
+                                  ImageLayout layout, PipelineStageFlags2 dstStages, AccessFlags2 dstAccess) {
+    return upload(data, size, [&](const CommandBuffer &commandBuffer, const Buffer &staging, Acquires &acquires) {
+        ImageSubresourceRange range(ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+        ImageMemoryBarrier2 toTransfer;
+        toTransfer.dstStageMask = PipelineStageFlagBits2::eTransfer;
+        toTransfer.dstAccessMask = AccessFlagBits2::eTransferWrite;
+        toTransfer.oldLayout = ImageLayout::eUndefined;
+        toTransfer.newLayout = ImageLayout::eTransferDstOptimal;
+        toTransfer.image = image;
+        toTransfer.subresourceRange = range;
+        recordBarriers(commandBuffer, {toTransfer}, {}, m_synchronization2, *m_dld);
+
+        BufferImageCopy copy;
+        copy.imageSubresource = ImageSubresourceLayers(ImageAspectFlagBits::eColor, 0, 0, 1);
+        copy.imageExtent = extent;
+        commandBuffer.copyBufferToImage(staging, image, ImageLayout::eTransferDstOptimal, copy);
+
+        // Both halves of an ownership transfer repeat the layout transition
+        ImageMemoryBarrier2 barrier;
+        barrier.srcStageMask = PipelineStageFlagBits2::eTransfer;
+        barrier.srcAccessMask = AccessFlagBits2::eTransferWrite;
+        barrier.dstStageMask = dstStages;
+        barrier.dstAccessMask = dstAccess;
+        barrier.oldLayout = ImageLayout::eTransferDstOptimal;
+        barrier.newLayout = layout;
+        barrier.image = image;
+        barrier.subresourceRange = range;
+        recordTransfer(commandBuffer, nullptr, &barrier, acquires);
+    });
+}
+
+void UploadQueue::acquire(const CommandBuffer &commandBuffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_dedicated || (m_acquires.buffers.empty() && m_acquires.images.empty())) {
+        return;
+    }
+    recordBarriers(commandBuffer, m_acquires.images, m_acquires.buffers, m_synchronization2, *m_dld);
+    m_acquires.buffers.clear();
+    m_acquires.images.clear();
+    m_acquiredUpload = m_submittedUpload;
+}
+
+void UploadQueue::submit(SubmitBatcher &batcher, const Queue &graphicsQueue, uint64_t frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_dedicated) {
+        if (m_acquiredUpload > 0) {
+            batcher.wait(graphicsQueue, m_timeline, PipelineStageFlagBits2::eAllCommands, m_acquiredUpload);
+            m_acquiredUpload = 0;
+        }
+        return;
+    }
+    if (m_pendingSubmits.empty()) {
+        return;
+    }
+    for (const auto &commandBuffer: m_pendingSubmits) {
+        batcher.submit(graphicsQueue, commandBuffer);
+    }
+    m_pendingSubmits.clear();
+    m_frameUploads.emplace_back(frame, m_submittedUpload);
+}
+
+void UploadQueue::update(uint64_t completedFrame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (!m_frameUploads.empty() && m_frameUploads.front().first <= completedFrame) {
+        m_completedUpload.store(m_frameUploads.front().second, std::memory_order_release);
+        m_frameUploads.erase(m_frameUploads.begin());
+    }
+}
@@ -7,10 +7,12 @@
 #include <sstream>
 #include <filesystem>
 #include <set>
+#include <algorithm>
 
 #include "Nest/Logger/Logger.hpp"
 #include "Nest/Settings/SettingsLog.hpp"
 #include "Nest/Application/Application.hpp"
+#include "Nest/Window/Events.hpp"
 #include "Nest/Renderer/Vulkan/Vulkan.hpp"
 #include "Nest/Renderer/Vulkan/Device.hpp"
 #include "Nest/Renderer/Vulkan/Instance.hpp"
@@ -20,9 +22,67 @@
 #include "Nest/Renderer/Vulkan/Sync.hpp"
 #include "Nest/Renderer/Vulkan/Commands.hpp"
 #include "Nest/Renderer/Vulkan/Framebuffer.hpp"
+#include "Nest/Renderer/Vulkan/QueueFamilies.hpp"
+#include "Nest/Jobs/JobSystem.hpp"
 
 using namespace vk;
 
+// Presents which never reach the screen, e.g. of a hidden window, must not stall rendering
+static constexpr uint64_t presentWaitTimeout = 100'000'000;
+
+static PresentModeKHR toPresentMode(GlobalSettings::PresentMode presentMode) {
+    switch (presentMode) {
+        case GlobalSettings::FifoRelaxed:
+            return PresentModeKHR::eFifoRelaxed;
+        case GlobalSettings::Mailbox:
+            return PresentModeKHR::eMailbox;
+        case GlobalSettings::Immediate:
+            return PresentModeKHR::eImmediate;
+        default:
+            return PresentModeKHR::eFifo;
+    }
+}
+
+// Only the recording counters, the rest of the frame stats is filled by render() and must survive
+static void addDrawStats(FrameStats &stats, const FrameStats &recorded) {
+    stats.draws += recorded.draws;
+    stats.pipelineBinds += recorded.pipelineBinds;
+    stats.descriptorBinds += recorded.descriptorBinds;
+    stats.pipelineBindsSaved += recorded.pipelineBindsSaved;
+    stats.descriptorBindsSaved += recorded.descriptorBindsSaved;
+    stats.rasterStateChanges += recorded.rasterStateChanges;
+}
+
+static RasterState toRasterState(const RenderRasterState &state) {
+    RasterState rasterState;
+    switch (state.topology) {
+        case RenderRasterState::Triangles:
+            rasterState.topology = PrimitiveTopology::eTriangleList;
+            break;
+        case RenderRasterState::Lines:
+            rasterState.topology = PrimitiveTopology::eLineList;
+            break;
+        case RenderRasterState::Points:
+            rasterState.topology = PrimitiveTopology::ePointList;
+            break;
+    }
+    switch (state.cullMode) {
+        case RenderRasterState::CullNone:
+            rasterState.cullMode = CullModeFlagBits::eNone;
+            break;
+        case RenderRasterState::CullFront:
+            rasterState.cullMode = CullModeFlagBits::eFront;
+            break;
+        case RenderRasterState::CullBack:
+            rasterState.cullMode = CullModeFlagBits::eBack;
+            break;
+    }
+    rasterState.depthTest = state.depthTest;
+    rasterState.depthWrite = state.depthWrite;
+    rasterState.blendEnable = state.blend;
+    return rasterState;
+}
+
 static std::string localPath = std::filesystem::current_path().parent_path().parent_path().parent_path().string() + "/";
 
 Vulkan::Vulkan()
@@ -31,13 +91,36 @@ Vulkan::Vulkan()
 
 Vulkan::~Vulkan() {
     logicalDevice.waitIdle();
-    logicalDevice.destroyCommandPool(commandPool);
 
-    logicalDevice.destroyPipeline(pipeline);
+    pipelineLibrary.destroy();
     logicalDevice.destroyPipelineLayout(pipelineLayout);
+    logicalDevice.destroyPipelineLayout(gpuDrivenPipelineLayout);
+    gpuScene.destroy();
+    asyncCompute.destroy();
+    uploadQueue.destroy();
+    gpuProfiler.destroy();
+    cameraBuffers.destroy();
+    if (capabilities.descriptorIndexing) {
+        bindlessHeap.destroy();
+    }
+    descriptorAllocator.destroy();
+    renderGraph.destroy();
+    pipelineStatistics.destroy();
+    stateTracker.destroy();
     logicalDevice.destroyRenderPass(renderPass);
 
     cleanupSwapchain();
+    staticCommands.destroy();
+    for (const auto &frame: frames) {
+        logicalDevice.destroyFence(frame.inFlight);
+        logicalDevice.destroyFence(frame.presentFence);
+        logicalDevice.destroySemaphore(frame.imageAvailable);
+        for (const auto &threadPool: frame.threadPools) {
+            logicalDevice.destroyCommandPool(threadPool.pool);
+        }
+    }
+    logicalDevice.destroySemaphore(graphicsTimeline.semaphore);
+    logicalDevice.destroyCommandPool(commandPool);
 
     logicalDevice.destroy();
     instance.destroySurfaceKHR(surface);
@@ -49,6 +132,7 @@ Vulkan::~Vulkan() {
 
 void Vulkan::init(const GlobalSettings &globalSettings) {
     m_globalSettings = globalSettings;
+    stallDetector.init(m_globalSettings.debugMode);
     makeInstance();
     makeDevice();
     makePipeline();
@@ -101,11 +185,35 @@ void Vulkan::makeDevice() {
                     logDeviceProperties(availableDevices[numDevice], devicesTypes[numDevice]);
                 }
                 physicalDevice = availableDevices[numDevice];
-                logicalDevice = createLogicalDevice(physicalDevice, surface, m_globalSettings.debugMode);
+                capabilities = queryDeviceCapabilities(physicalDevice, getInstanceApiVersion());
+                // Present fences also need the surface side of the extension on the instance
+                capabilities.swapchainMaintenance1 = capabilities.swapchainMaintenance1 &&
+                                                     supported({VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME}, {});
+                // Query features are only enabled when the statistics are asked for
+                capabilities.pipelineStatisticsQuery = capabilities.pipelineStatisticsQuery &&
+                                                       m_globalSettings.pipelineStatistics;
+                logicalDevice = createLogicalDevice(physicalDevice, surface, capabilities,
+                                                    m_globalSettings.debugMode);
+                // Extension entry points are loaded through the dynamic dispatcher
+                dld.init(logicalDevice);
                 auto queue = getQueues(physicalDevice, logicalDevice, surface, m_globalSettings.debugMode);
                 graphicsQueue = queue[0];
                 presentQueue = queue[1];
+                computeQueue = queue[2];
+                transferQueue = queue[3];
                 makeSwapchain();
+                maxFramesInFlight = std::clamp(m_globalSettings.framesInFlight, 1, 3);
+                frames.resize(maxFramesInFlight);
+                asyncCompute.init(logicalDevice, findQueueFamilies(physicalDevice, surface), computeQueue,
+                                  graphicsQueue, maxFramesInFlight, capabilities.synchronization2, dld,
+                                  m_globalSettings.debugMode);
+                uploadQueue.init(logicalDevice, physicalDevice, findQueueFamilies(physicalDevice, surface),
+                                 transferQueue, capabilities.timelineSemaphore, capabilities.synchronization2, dld,
+                                 m_globalSettings.debugMode);
+                // Labels need VK_EXT_debug_utils, which is only enabled with the debug messenger
+                gpuProfiler.init(logicalDevice, physicalDevice,
+                                 findQueueFamilies(physicalDevice, surface).graphicsFamily.value(), maxFramesInFlight,
+                                 VK_PRINT_INSTANCE_INFO, dld, m_globalSettings.debugMode);
                 frameNumber = 0;
                 return;
             }
@@ -116,82 +224,221 @@ void Vulkan::makeDevice() {
 void Vulkan::makeSwapchain() {
     SwapChainBundle bundle = createSwapchain(logicalDevice, physicalDevice, surface,
                                  m_globalSettings.resolutionX,
-                                 m_globalSettings.resolutionY);
+                                 m_globalSettings.resolutionY, toPresentMode(m_globalSettings.presentMode));
     swapchain = bundle.swapchain;
     swapchainFrames = bundle.frames;
     swapchainFormat = bundle.format;
     swapchainExtent = bundle.extent;
-    maxFramesInFlight = static_cast<int>(swapchainFrames.size());
 }
 
-void Vulkan::recreateSwapchain() {
-//    m_globalSettings.resolutionX = 0;
-//    m_globalSettings.resolutionY = 0;
-    while (m_globalSettings.resolutionX == 0 || m_globalSettings.resolutionY == 0) {
-        glfwGetFramebufferSize((GLFWwindow *) Application::getInstance()->getWindow()->getNativeHandle(),
-                               &m_globalSettings.resolutionX, &m_globalSettings.resolutionY);
-        glfwWaitEvents();
+const FrameStats &Vulkan::getFrameStats() const {
+    return frameStats;
+}
+
+void Vulkan::resize(int width, int height) {
+    m_globalSettings.resolutionX = width;
+    m_globalSettings.resolutionY = height;
+    swapchainOutdated = true;
+}
+
+bool Vulkan::recreateSwapchain() {
+    // The size comes from resize(), GLFW can't be queried from a render thread.
+    // A minimized window has no surface area, frames are skipped until it is restored. The application sleeps in
+    // the meantime, so this only happens for the packets that were already queued.
+    if (m_globalSettings.resolutionX == 0 || m_globalSettings.resolutionY == 0) {
+        return false;
     }
-    logicalDevice.waitIdle();
 
     SwapChainBundle bundle = createSwapchain(logicalDevice, physicalDevice, surface,
                                  m_globalSettings.resolutionX,
-                                 m_globalSettings.resolutionY, &swapchain);
-    cleanupSwapchain();
+                                 m_globalSettings.resolutionY, toPresentMode(m_globalSettings.presentMode),
+                                 &swapchain);
+
+    // Frames in flight are not tied to the images and are kept as they are
+    retireSwapchain();
+
     swapchain = bundle.swapchain;
     swapchainFrames = bundle.frames;
     swapchainFormat = bundle.format;
     swapchainExtent = bundle.extent;
-    maxFramesInFlight = static_cast<int>(swapchainFrames.size());
-    makeFramebuffer();
-    makeFrameSync();
-    commandPool = makeCommandPool(logicalDevice, physicalDevice, surface, m_globalSettings.debugMode);
 
-    CommandBufferInputChunk commandBufferInput = {logicalDevice, commandPool, swapchainFrames};
-    makeFrameCommandBuffers(commandBufferInput);
+    makeFramebuffer();
+    makeImageSync();
+    // Recordings reference the old framebuffers and extent
+    staticCommands.resize(swapchainFrames.size(), submittedFrames);
+    cameraBuffers.resize(swapchainFrames.size(), submittedFrames);
+
+    swapchainFirstPresentId = submittedFrames + 1;
+    swapchainOutdated = false;
+    return true;
+}
 
+void Vulkan::waitForPresent(uint64_t presentId) {
+    if (presentId < swapchainFirstPresentId) {
+        return;
+    }
+    StallDetector::Scope stall(stallDetector, StallDetector::Point::Present);
+    try {
+        // A timeout is reported as a result and the frame goes ahead
+        Result result = logicalDevice.waitForPresentKHR(swapchain, presentId, presentWaitTimeout, dld);
+        if (result == Result::eSuboptimalKHR) {
+            swapchainOutdated = true;
+        }
+        if (result != Result::eTimeout) {
+            latencyTracker.displayed(presentId, Events::getTime());
+        }
+    } catch (const OutOfDateKHRError &error) {
+        swapchainOutdated = true;
+    } catch (const SystemError &err) {
+        if (m_globalSettings.debugMode) {
+            LOG_ERROR("Failed to wait for present!\n{}", err.what());
+        }
+    }
 }
 
-void Vulkan::cleanupSwapchain() {
-    for (const auto &frame: swapchainFrames) {
+void Vulkan::destroySwapchainFrames(const std::vector<SwapChainFrame> &frames) {
+    for (const auto &frame: frames) {
         logicalDevice.destroyImageView(frame.imageView);
         logicalDevice.destroyFramebuffer(frame.framebuffer);
-        logicalDevice.destroyFence(frame.inFlight);
-        logicalDevice.destroySemaphore(frame.imageAvailable);
         logicalDevice.destroySemaphore(frame.renderFinished);
     }
+}
+
+void Vulkan::retireSwapchain() {
+    // The old swapchain may still be presenting, so it is destroyed once its last frame is released
+    uint64_t retireFrame = submittedFrames;
+    if (!capabilities.swapchainMaintenance1) {
+        // Without present fences wait until every old image could have been presented and released
+        retireFrame += swapchainFrames.size();
+    }
+    SwapchainKHR retiredSwapchain = swapchain;
+    std::vector<SwapChainFrame> retiredFrames = std::move(swapchainFrames);
+    for (const auto &frame: retiredFrames) {
+        stateTracker.removeImage(frame.image);
+    }
+    deletionQueue.push(retireFrame, [this, retiredSwapchain, retiredFrames]() {
+        destroySwapchainFrames(retiredFrames);
+        logicalDevice.destroySwapchainKHR(retiredSwapchain);
+    });
+}
 
+void Vulkan::cleanupSwapchain() {
+    destroySwapchainFrames(swapchainFrames);
+    swapchainFrames.clear();
     logicalDevice.destroySwapchainKHR(swapchain);
+    deletionQueue.flushAll();
 }
 
 void Vulkan::makePipeline() {
-    GraphicsPipelineInBundle specification;
+    dynamicRasterState.extendedDynamicState = capabilities.extendedDynamicState;
+    dynamicRasterState.extendedDynamicState2 = capabilities.extendedDynamicState2;
+    dynamicRasterState.polygonMode = capabilities.extendedDynamicState3PolygonMode;
+    dynamicRasterState.blendEnable = capabilities.extendedDynamicState3ColorBlendEnable;
+
+    std::string shaderDirectory = localPath + "Nest/res/Shaders/CompileShaders/";
+    GraphicsPipelineInBundle &specification = pipelineSpecification;
     specification.device = logicalDevice;
-    specification.swapchainExtent = swapchainExtent;
     specification.swapchainImageFormat = swapchainFormat;
-    specification.vertexFilepath = localPath + "Nest/res/Shaders/CompileShaders/vst.spv";
-    specification.fragmentFilepath = localPath + "Nest/res/Shaders/CompileShaders/fst.spv";
-
-    GraphicsPipelineOutBundle output = makeGraphicsPipeline(specification,
-                                                            m_globalSettings.debugMode);
-    pipeline = output.pipeline;
-    pipelineLayout = output.layout;
-    renderPass = output.renderPass;
+    specification.vertexFilepath = shaderDirectory + "vst.spv";
+    specification.fragmentFilepath = shaderDirectory + "fst.spv";
+    specification.rasterState = rasterState;
+    specification.dynamicState = dynamicRasterState;
+
+    descriptorAllocator.init(logicalDevice, maxFramesInFlight, m_globalSettings.debugMode);
+
+    // Set 0 is the camera, set 1 the bindless heap
+    cameraBuffers.init(logicalDevice, physicalDevice, deletionQueue, m_globalSettings.debugMode);
+    std::vector<DescriptorSetLayout> setLayouts = {cameraBuffers.getLayout()};
+    if (capabilities.descriptorIndexing) {
+        bindlessHeap.init(logicalDevice, physicalDevice, m_globalSettings.debugMode);
+        setLayouts.emplace_back(bindlessHeap.getLayout());
+    }
+    std::vector<PushConstantRange> pushConstantRanges = {
+            makePushConstantRange<DrawPushConstants>(ShaderStageFlagBits::eVertex | ShaderStageFlagBits::eFragment)
+    };
+    if (validatePushConstantRanges(physicalDevice, pushConstantRanges, m_globalSettings.debugMode)) {
+        drawPushConstantStages = pushConstantRanges[0].stageFlags;
+    } else {
+        pushConstantRanges.clear();
+    }
+    pipelineLayout = makePipelineLayout(logicalDevice, setLayouts, pushConstantRanges, m_globalSettings.debugMode);
+    // With dynamic rendering the render pass stays null and pipelines take the attachment formats instead
+    if (!capabilities.dynamicRendering) {
+        renderPass = makeRenderpass(logicalDevice, swapchainFormat, m_globalSettings.debugMode);
+    }
+    pipelineLibrary.init(logicalDevice, deletionQueue, capabilities.graphicsPipelineLibrary,
+                         capabilities.graphicsPipelineLibraryFastLinking, m_globalSettings.debugMode);
+    pipelineId = pipelineLibrary.requestPipeline(specification, pipelineLayout, renderPass);
+    pipeline = pipelineLibrary.getPipeline(pipelineId);
+
+    gpuScene.init(logicalDevice, physicalDevice, capabilities, descriptorAllocator, asyncCompute, uploadQueue,
+                  maxFramesInFlight, shaderDirectory, dld, m_globalSettings.debugMode);
+    if (gpuScene.isSupported()) {
+        std::vector<PushConstantRange> gpuDrivenRanges = {
+                makePushConstantRange<GpuDrawPushConstants>(ShaderStageFlagBits::eVertex)
+        };
+        gpuDrivenPipelineLayout = makePipelineLayout(logicalDevice, {gpuScene.getLayout()}, gpuDrivenRanges,
+                                                     m_globalSettings.debugMode);
+        GraphicsPipelineInBundle gpuDrivenSpecification = specification;
+        gpuDrivenSpecification.vertexFilepath = shaderDirectory + "gpuDriven.spv";
+        gpuDrivenPipelineId = pipelineLibrary.requestPipeline(gpuDrivenSpecification, gpuDrivenPipelineLayout,
+                                                              renderPass);
+        gpuDrivenPipeline = pipelineLibrary.getPipeline(gpuDrivenPipelineId);
+    }
 }
 
 void Vulkan::finalizeSetup() {
     makeFramebuffer();
     commandPool = makeCommandPool(logicalDevice, physicalDevice, surface, m_globalSettings.debugMode);
 
-    CommandBufferInputChunk commandBufferInput = {logicalDevice, commandPool, swapchainFrames};
+    CommandBufferInputChunk commandBufferInput = {logicalDevice, commandPool, frames};
 
     mainCommandBuffer = makeCommandBuffer(commandBufferInput);
     makeFrameCommandBuffers(commandBufferInput);
 
+    makeThreadCommandPools();
+
     makeFrameSync();
+    makeImageSync();
+
+    stateTracker.init(logicalDevice, capabilities.synchronization2, maxFramesInFlight, dld,
+                      m_globalSettings.debugMode);
+    renderGraph.init(logicalDevice, physicalDevice, deletionQueue, stateTracker, m_globalSettings.debugMode);
+    if (capabilities.pipelineStatisticsQuery) {
+        pipelineStatistics.init(logicalDevice, maxFramesInFlight, m_globalSettings.debugMode);
+        if (pipelineStatistics.isEnabled()) {
+            renderGraph.setPipelineStatistics(&pipelineStatistics);
+        }
+    }
+    submitBatcher.init(capabilities.synchronization2, capabilities.timelineSemaphore, dld, m_globalSettings.debugMode);
+    staticCommands.init(logicalDevice, findQueueFamilies(physicalDevice, surface).graphicsFamily.value(),
+                        deletionQueue, m_globalSettings.debugMode);
+    staticCommands.resize(swapchainFrames.size(), submittedFrames);
+    cameraBuffers.resize(swapchainFrames.size(), submittedFrames);
+
+    drawCommands.push_back({3, 1, 0, 0, DrawPushConstants(), pipelineId, rasterState});
+    setupDrawCount = drawCommands.size();
+    drawCommandsDirty = true;
+    // The triangle of gpuDriven.vert, instances referencing mesh 0 draw it
+    gpuScene.addMesh({0, 1, 2});
+}
+
+void Vulkan::makeThreadCommandPools() {
+    uint32_t graphicsFamily = findQueueFamilies(physicalDevice, surface).graphicsFamily.value();
+    for (auto &frame: frames) {
+        frame.threadPools.resize(JobSystem::getThreadCount());
+        for (auto &threadPool: frame.threadPools) {
+            threadPool.pool = makeCommandPool(logicalDevice, graphicsFamily, CommandPoolCreateFlagBits::eTransient,
+                                              m_globalSettings.debugMode);
+        }
+    }
 }
 
 void Vulkan::makeFramebuffer() {
+    // Dynamic rendering renders straight into the image views
+    if (capabilities.dynamicRendering) {
+        return;
+    }
     FramebufferInput framebufferInput;
     framebufferInput.device = logicalDevice;
     framebufferInput.renderPass = renderPass;
@@ -200,14 +447,82 @@ void Vulkan::makeFramebuffer() {
 }
 
 void Vulkan::makeFrameSync() {
-    for (auto &frame: swapchainFrames) {
-        frame.inFlight = makeFence(logicalDevice, m_globalSettings.debugMode);
+    if (capabilities.timelineSemaphore) {
+        graphicsTimeline.semaphore = makeTimelineSemaphore(logicalDevice, 0, m_globalSettings.debugMode);
+    }
+    for (auto &frame: frames) {
+        if (!capabilities.timelineSemaphore) {
+            frame.inFlight = makeFence(logicalDevice, m_globalSettings.debugMode);
+        }
         frame.imageAvailable = makeSemaphore(logicalDevice, m_globalSettings.debugMode);
-        frame.renderFinished = makeSemaphore(logicalDevice, m_globalSettings.debugMode);
+        if (capabilities.swapchainMaintenance1) {
+            frame.presentFence = makeFence(logicalDevice, m_globalSettings.debugMode);
+        }
+    }
+}
+
+void Vulkan::makeImageSync() {
+    for (auto &swapchainFrame: swapchainFrames) {
+        swapchainFrame.renderFinished = makeSemaphore(logicalDevice, m_globalSettings.debugMode);
     }
 }
 
-void Vulkan::recordDrawCommands(const CommandBuffer &commandBuffer, uint32_t imageIndex) {
+void Vulkan::waitForFrame(uint64_t frame) {
+    if (frame <= completedFrames) {
+        return;
+    }
+    if (capabilities.timelineSemaphore) {
+        waitTimeline(logicalDevice, graphicsTimeline, frame, dld);
+        completedFrames = std::max(completedFrames, graphicsTimeline.completedValue);
+        return;
+    }
+    // The earliest fence submitted after the frame covers it, as submissions complete in order
+    const FrameResources *owner = nullptr;
+    for (const auto &resources: frames) {
+        if (resources.submittedFrame >= frame && (!owner || resources.submittedFrame < owner->submittedFrame)) {
+            owner = &resources;
+        }
+    }
+    if (owner) {
+        logicalDevice.waitForFences(1, &owner->inFlight, VK_TRUE, UINT64_MAX);
+        completedFrames = std::max(completedFrames, owner->submittedFrame);
+    }
+}
+
+uint64_t Vulkan::getReleasedFrame() const {
+    if (capabilities.swapchainMaintenance1) {
+        return std::min(completedFrames, presentedFrames);
+    }
+    return completedFrames;
+}
+
+void Vulkan::buildRenderGraph(uint32_t imageIndex, FrameResources &frame) {
+    renderGraph.reset(submittedFrames + 1);
+
+    RenderGraphTextureDesc backbufferDesc;
+    backbufferDesc.extent = swapchainExtent;
+    backbufferDesc.format = swapchainFormat;
+    renderGraph.importTexture("Backbuffer", swapchainFrames[imageIndex].image, swapchainFrames[imageIndex].imageView,
+                              backbufferDesc, ImageLayout::eUndefined, ImageLayout::ePresentSrcKHR);
+
+    gpuDrivenFrame = gpuScene.isSupported() && gpuScene.getInstanceCount() > 0;
+    if (gpuDrivenFrame) {
+        gpuScene.addCullPasses(renderGraph, frameNumber);
+    }
+
+    renderGraph.addPass("Main", [this](RenderGraphBuilder &builder) {
+        builder.write("Backbuffer", RenderGraphAccess::ColorAttachment);
+        if (gpuDrivenFrame) {
+            gpuScene.declareDrawReads(builder);
+        }
+    }, [this, imageIndex, &frame](const CommandBuffer &commandBuffer) {
+        recordMainPass(commandBuffer, imageIndex, frame);
+    });
+
+    renderGraph.compile();
+}
+
+void Vulkan::recordDrawCommands(const CommandBuffer &commandBuffer) {
     CommandBufferBeginInfo beginInfo;
     try {
         commandBuffer.begin(beginInfo);
@@ -217,109 +532,489 @@ void Vulkan::recordDrawCommands(const CommandBuffer &commandBuffer, uint32_t ima
         }
     }
 
-    RenderPassBeginInfo renderPassInfo;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = swapchainFrames[imageIndex].framebuffer;
-    renderPassInfo.renderArea.offset.x = 0;
-    renderPassInfo.renderArea.offset.y = 0;
-    renderPassInfo.renderArea.extent = swapchainExtent;
+    gpuProfiler.beginFrame(frameNumber, commandBuffer);
+    if (pipelineStatistics.isEnabled()) {
+        pipelineStatistics.beginFrame(frameNumber, commandBuffer);
+    }
+    {
+        GPU_ZONE(commandBuffer, "Frame");
+        // Resources the compute work of the frame hands over to graphics
+        asyncCompute.acquire(commandBuffer);
+        uploadQueue.acquire(commandBuffer);
+        renderGraph.execute(commandBuffer);
+    }
 
+    try {
+        commandBuffer.end();
+    } catch (const SystemError &err) {
+        if (m_globalSettings.debugMode) {
+            LOG_ERROR("Failed to record command buffer!\n{}", err.what());
+        }
+    }
+}
+
+void Vulkan::recordMainPass(const CommandBuffer &commandBuffer, uint32_t imageIndex, FrameResources &frame) {
+    // GPU-driven draws bind descriptor sets allocated every frame and can't be replayed
+    if (m_globalSettings.staticCommandBuffers && !gpuDrivenFrame) {
+        CommandBuffer recording = staticCommands.get(imageIndex);
+        if (recording) {
+            addDrawStats(frameStats, staticCommands.getStats(imageIndex));
+            ++frameStats.commandBuffersReused;
+        } else {
+            CommandBufferInheritanceInfo inheritanceInfo;
+            CommandBufferInheritanceRenderingInfo inheritanceRenderingInfo;
+            makeInheritanceInfo(imageIndex, inheritanceInfo, inheritanceRenderingInfo);
+            // The last frame rendering to the image has completed, so its recording is free to reset
+            CommandBuffer secondary = staticCommands.begin(imageIndex, inheritanceInfo);
+            if (secondary) {
+                FrameStats recorded;
+                recordDraws(secondary, imageIndex, 0, static_cast<uint32_t>(renderQueue.size()), recorded);
+                staticCommands.end(imageIndex, recorded);
+                recording = staticCommands.get(imageIndex);
+                if (recording) {
+                    addDrawStats(frameStats, recorded);
+                }
+            }
+        }
+        if (recording) {
+            beginRenderTarget(commandBuffer, imageIndex, true);
+            commandBuffer.executeCommands(recording);
+            endRenderTarget(commandBuffer, imageIndex);
+            return;
+        }
+    }
+
+    // Small scenes are not worth the job overhead and are recorded inline
+    uint32_t drawCount = static_cast<uint32_t>(renderQueue.size());
+    uint32_t jobCount = std::min(JobSystem::getThreadCount(),
+                                 (drawCount + minDrawsPerRecordingJob - 1) / minDrawsPerRecordingJob);
+    if (jobCount <= 1) {
+        beginRenderTarget(commandBuffer, imageIndex, false);
+        recordDraws(commandBuffer, imageIndex, 0, drawCount, frameStats);
+        recordGpuDrivenDraws(commandBuffer, frameStats);
+    } else {
+        std::vector<FrameStats> jobStats(jobCount);
+        std::vector<CommandBuffer> secondaryCommandBuffers(jobCount);
+        // A chunk that fails leaves its slot null, nothing may throw out of a worker
+        JobSystem::parallelFor(jobCount, [&](uint32_t index, uint32_t threadIndex) {
+            CommandBuffer secondary = acquireSecondaryCommandBuffer(logicalDevice, frame.threadPools[threadIndex]);
+            if (!secondary) {
+                return;
+            }
+
+            CommandBufferInheritanceInfo inheritanceInfo;
+            CommandBufferInheritanceRenderingInfo inheritanceRenderingInfo;
+            makeInheritanceInfo(imageIndex, inheritanceInfo, inheritanceRenderingInfo);
+
+            CommandBufferBeginInfo secondaryBeginInfo;
+            secondaryBeginInfo.flags = CommandBufferUsageFlagBits::eOneTimeSubmit |
+                                       CommandBufferUsageFlagBits::eRenderPassContinue;
+            secondaryBeginInfo.pInheritanceInfo = &inheritanceInfo;
+            try {
+                secondary.begin(secondaryBeginInfo);
+                recordDraws(secondary, imageIndex, drawCount * index / jobCount,
+                            drawCount * (index + 1) / jobCount, jobStats[index]);
+                if (index == 0) {
+                    recordGpuDrivenDraws(secondary, jobStats[index]);
+                }
+                secondary.end();
+            } catch (const SystemError &err) {
+                if (m_globalSettings.debugMode) {
+                    LOG_ERROR("Failed to record draw chunk {}\n{}", index, err.what());
+                }
+                return;
+            }
+            secondaryCommandBuffers[index] = secondary;
+        });
+        bool recorded = std::all_of(secondaryCommandBuffers.begin(), secondaryCommandBuffers.end(),
+                                    [](const CommandBuffer &secondary) { return static_cast<bool>(secondary); });
+        if (recorded) {
+            beginRenderTarget(commandBuffer, imageIndex, true);
+            commandBuffer.executeCommands(secondaryCommandBuffers);
+            for (const auto &stats: jobStats) {
+                addDrawStats(frameStats, stats);
+            }
+        } else {
+            // A render target takes either inline commands or secondaries, so the whole pass is recorded again.
+            // The finished chunks are never submitted and are recycled with their pools.
+            beginRenderTarget(commandBuffer, imageIndex, false);
+            recordDraws(commandBuffer, imageIndex, 0, drawCount, frameStats);
+            recordGpuDrivenDraws(commandBuffer, frameStats);
+        }
+    }
+
+    endRenderTarget(commandBuffer, imageIndex);
+}
+
+void Vulkan::makeInheritanceInfo(uint32_t imageIndex, CommandBufferInheritanceInfo &inheritanceInfo,
+                                 CommandBufferInheritanceRenderingInfo &renderingInfo) const {
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &swapchainFormat;
+    renderingInfo.rasterizationSamples = SampleCountFlagBits::e1;
+    // The pass executing the recording may have a statistics query active
+    if (pipelineStatistics.isEnabled()) {
+        inheritanceInfo.pipelineStatistics = PipelineStatistics::flags;
+    }
+
+    if (capabilities.dynamicRendering) {
+        inheritanceInfo.pNext = &renderingInfo;
+    } else {
+        inheritanceInfo.renderPass = renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = swapchainFrames[imageIndex].framebuffer;
+    }
+}
+
+void Vulkan::beginRenderTarget(const CommandBuffer &commandBuffer, uint32_t imageIndex, bool secondaryContents) {
     std::array<float, 4> clearColorVal = {0.8, 1., 0., 1.};
     ClearValue clearColor(clearColorVal);
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
 
-    commandBuffer.beginRenderPass(&renderPassInfo, SubpassContents::eInline);
-    commandBuffer.bindPipeline(PipelineBindPoint::eGraphics, pipeline);
+    Rect2D renderArea;
+    renderArea.offset.x = 0;
+    renderArea.offset.y = 0;
+    renderArea.extent = swapchainExtent;
+
+    if (!capabilities.dynamicRendering) {
+        RenderPassBeginInfo renderPassInfo;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = swapchainFrames[imageIndex].framebuffer;
+        renderPassInfo.renderArea = renderArea;
+        renderPassInfo.clearValueCount = 1;
+        renderPassInfo.pClearValues = &clearColor;
+        commandBuffer.beginRenderPass(&renderPassInfo, secondaryContents ? SubpassContents::eSecondaryCommandBuffers
+                                                                         : SubpassContents::eInline);
+        return;
+    }
 
-    commandBuffer.draw(3, 1, 0, 0);
+    RenderingAttachmentInfo colorAttachment;
+    colorAttachment.imageView = swapchainFrames[imageIndex].imageView;
+    colorAttachment.imageLayout = ImageLayout::eColorAttachmentOptimal;
+    colorAttachment.loadOp = AttachmentLoadOp::eClear;
+    colorAttachment.storeOp = AttachmentStoreOp::eStore;
+    colorAttachment.clearValue = clearColor;
 
-    commandBuffer.endRenderPass();
+    RenderingInfo renderingInfo;
+    if (secondaryContents) {
+        renderingInfo.flags = RenderingFlagBits::eContentsSecondaryCommandBuffers;
+    }
+    renderingInfo.renderArea = renderArea;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+    commandBuffer.beginRendering(renderingInfo, dld);
+}
 
-    try {
-        commandBuffer.end();
-    } catch (const SystemError &err) {
-        if (m_globalSettings.debugMode) {
-            LOG_ERROR("Failed to record command buffer!\n{}", err.what());
+void Vulkan::endRenderTarget(const CommandBuffer &commandBuffer, uint32_t imageIndex) {
+    if (!capabilities.dynamicRendering) {
+        commandBuffer.endRenderPass();
+        return;
+    }
+    commandBuffer.endRendering(dld);
+}
+
+void Vulkan::applyPacket(const RenderPacket &packet) {
+    if (packet.resized) {
+        resize(packet.framebufferWidth, packet.framebufferHeight);
+    }
+    if (packet.presentMode != m_globalSettings.presentMode) {
+        m_globalSettings.presentMode = packet.presentMode;
+        swapchainOutdated = true;
+    }
+    gpuScene.setViewProjection(packet.viewProjection);
+
+    // Unchanged instances keep the uploaded scene buffers
+    if (packet.instances != packetInstances) {
+        packetInstances = packet.instances;
+        std::vector<GpuInstance> instances;
+        instances.reserve(packetInstances.size());
+        for (const auto &instance: packetInstances) {
+            instances.push_back({instance.transform, instance.boundingSphere, instance.meshIndex,
+                                 instance.materialIndex, instance.textureIndex, instance.samplerIndex});
         }
+        gpuScene.setInstances(instances);
+    }
+
+    // Unchanged draws keep the sorted queue and the static recordings
+    if (packet.draws == packetDraws) {
+        return;
+    }
+    packetDraws = packet.draws;
+    drawCommands.resize(setupDrawCount);
+    for (const auto &draw: packetDraws) {
+        DrawPushConstants constants;
+        constants.transform = draw.transform;
+        constants.materialIndex = draw.materialIndex;
+        constants.textureIndex = draw.textureIndex;
+        constants.samplerIndex = draw.samplerIndex;
+        // The library keys pipelines by baked state, so states the device sets dynamically return pipelineId again
+        GraphicsPipelineInBundle specification = pipelineSpecification;
+        specification.rasterState = toRasterState(draw.rasterState);
+        uint32_t drawPipelineId = pipelineLibrary.requestPipeline(specification, pipelineLayout, renderPass);
+        drawCommands.push_back({draw.vertexCount, draw.instanceCount, draw.firstVertex, draw.firstInstance, constants,
+                                drawPipelineId, specification.rasterState, 0, draw.depth, draw.translucent});
     }
+    drawCommandsDirty = true;
 }
 
-void Vulkan::render() {
-    auto currentFrame = swapchainFrames[frameNumber];
-    logicalDevice.waitForFences(1, &currentFrame.inFlight, VK_TRUE, UINT64_MAX);
+void Vulkan::buildRenderQueue() {
+    renderQueue.clear();
+    for (uint32_t i = 0; i < drawCommands.size(); ++i) {
+        const DrawCommand &draw = drawCommands[i];
+        renderQueue.push(makeSortKey(draw.pass, draw.pipelineId, draw.constants.materialIndex, draw.depth,
+                                     draw.translucent), i);
+    }
+    renderQueue.sort();
+}
+
+void Vulkan::recordDraws(const CommandBuffer &commandBuffer, uint32_t imageIndex, uint32_t firstItem,
+                         uint32_t lastItem, FrameStats &stats) {
+    // Secondary command buffers inherit no state, so every chunk sets it up again
+    Viewport viewport;
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float) swapchainExtent.width;
+    viewport.height = (float) swapchainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    commandBuffer.setViewport(0, 1, &viewport);
+
+    Rect2D scissor;
+    scissor.offset.x = 0;
+    scissor.offset.y = 0;
+    scissor.extent = swapchainExtent;
+    commandBuffer.setScissor(0, 1, &scissor);
+    // Every draw of the image reads the same camera
+    cameraBuffers.bind(commandBuffer, pipelineLayout, imageIndex);
+    ++stats.descriptorBinds;
+
+    // Sorted draws share state with their neighbours, binds are only recorded when it changes
+    Pipeline boundPipeline;
+    const RasterState *setRasterState = nullptr;
+    bool heapBound = false;
+    const std::vector<RenderQueueItem> &items = renderQueue.getItems();
+    for (uint32_t i = firstItem; i < lastItem; ++i) {
+        const DrawCommand &draw = drawCommands[items[i].drawIndex];
+        Pipeline drawPipeline = pipelineLibrary.getPipeline(draw.pipelineId);
+        if (drawPipeline != boundPipeline) {
+            commandBuffer.bindPipeline(PipelineBindPoint::eGraphics, drawPipeline);
+            boundPipeline = drawPipeline;
+            ++stats.pipelineBinds;
+        } else {
+            ++stats.pipelineBindsSaved;
+        }
+        if (!setRasterState || !(draw.rasterState == *setRasterState)) {
+            setDynamicRasterState(commandBuffer, draw.rasterState, dynamicRasterState, dld);
+            setRasterState = &draw.rasterState;
+            ++stats.rasterStateChanges;
+        }
+        // Materials select their resources from the heap by index, it never changes between draws
+        if (capabilities.descriptorIndexing) {
+            if (!heapBound) {
+                bindlessHeap.bind(commandBuffer, PipelineBindPoint::eGraphics, pipelineLayout, 1);
+                heapBound = true;
+                ++stats.descriptorBinds;
+            } else {
+                ++stats.descriptorBindsSaved;
+            }
+        }
+        if (drawPushConstantStages) {
+            pushConstants(commandBuffer, pipelineLayout, drawPushConstantStages, draw.constants);
+        }
+        commandBuffer.draw(draw.vertexCount, draw.instanceCount, draw.firstVertex, draw.firstInstance);
+        ++stats.draws;
+    }
+}
+
+void Vulkan::recordGpuDrivenDraws(const CommandBuffer &commandBuffer, FrameStats &stats) {
+    if (!gpuDrivenFrame) {
+        return;
+    }
+    // Viewport and scissor set by recordDraws carry over, the raster state is whatever the last draw used
+    commandBuffer.bindPipeline(PipelineBindPoint::eGraphics, gpuDrivenPipeline);
+    setDynamicRasterState(commandBuffer, rasterState, dynamicRasterState, dld);
+    ++stats.rasterStateChanges;
+    pushConstants(commandBuffer, gpuDrivenPipelineLayout, ShaderStageFlagBits::eVertex,
+                  gpuScene.getDrawPushConstants());
+    gpuScene.draw(commandBuffer, gpuDrivenPipelineLayout);
+    ++stats.pipelineBinds;
+    ++stats.descriptorBinds;
+    ++stats.draws;
+}
+
+void Vulkan::render(const RenderPacket &packet) {
+    // A frame lasts from one render call to the next, so time outside of it counts as CPU time
+    stallDetector.beginFrame();
+    applyPacket(packet);
+
+    // Pick up link time optimized pipelines compiled in the background
+    if (pipelineLibrary.update(submittedFrames)) {
+        pipeline = pipelineLibrary.getPipeline(pipelineId);
+        if (gpuScene.isSupported()) {
+            gpuDrivenPipeline = pipelineLibrary.getPipeline(gpuDrivenPipelineId);
+        }
+        staticCommands.invalidate();
+    }
+
+    if (swapchainOutdated && !recreateSwapchain()) {
+        return;
+    }
+    // Frames queued for presentation only add latency, starting later samples newer input
+    if (capabilities.presentWait && m_globalSettings.presentThrottle && submittedFrames > 1) {
+        waitForPresent(submittedFrames - 1);
+    }
+
+    FrameResources &currentFrame = frames[frameNumber];
+    if (capabilities.timelineSemaphore) {
+        completedFrames = std::max(completedFrames, pollTimeline(logicalDevice, graphicsTimeline, dld));
+    }
+    {
+        StallDetector::Scope stall(stallDetector, StallDetector::Point::GpuWait);
+        waitForFrame(currentFrame.submittedFrame);
+    }
+    // Without present waits GPU completion is the closest the frames can be seen to reach the screen
+    if (!capabilities.presentWait || !m_globalSettings.presentThrottle) {
+        latencyTracker.displayed(completedFrames, Events::getTime());
+    }
+    if (capabilities.swapchainMaintenance1) {
+        StallDetector::Scope stall(stallDetector, StallDetector::Point::Present);
+        logicalDevice.waitForFences(1, &currentFrame.presentFence, VK_TRUE, UINT64_MAX);
+        presentedFrames = std::max(presentedFrames, currentFrame.submittedFrame);
+    }
+    deletionQueue.flush(getReleasedFrame());
+    for (auto &threadPool: currentFrame.threadPools) {
+        resetThreadCommandPool(logicalDevice, threadPool);
+    }
+    descriptorAllocator.resetFrame(frameNumber);
+    stateTracker.beginFrame(frameNumber);
+    asyncCompute.beginFrame(frameNumber);
+    uploadQueue.update(completedFrames);
 
 //     acquireNextImageKHR(SwapChainKHR, timeout, semaphore_to_signal, fence)
 
     uint32_t imageIndex;
     try {
+        StallDetector::Scope stall(stallDetector, StallDetector::Point::Acquire);
         ResultValue acquire = logicalDevice.acquireNextImageKHR(
                 swapchain, UINT64_MAX,
-                swapchainFrames[frameNumber].imageAvailable, nullptr
+                currentFrame.imageAvailable, nullptr
         );
         imageIndex = acquire.value;
+        if (acquire.result == Result::eSuboptimalKHR) {
+            swapchainOutdated = true;
+        }
     } catch (const OutOfDateKHRError& error) {
-        LOG_INFO("Recreate Swapchain");
-        recreateSwapchain();
+        swapchainOutdated = true;
         return;
     } catch (const IncompatibleDisplayKHRError& error) {
-        LOG_INFO("Recreate Swapchain");
-        recreateSwapchain();
+        swapchainOutdated = true;
         return;
     } catch (const SystemError &error) {
         LOG_ERROR("Failed to acquire swapchain image!");
     }
 
+    // With more images than frames in flight an image can come back while an older frame still renders to it
+    SwapChainFrame &image = swapchainFrames[imageIndex];
+    {
+        StallDetector::Scope stall(stallDetector, StallDetector::Point::GpuWait);
+        waitForFrame(image.renderingFrame);
+    }
+
     CommandBuffer commandBuffer = currentFrame.commandBuffer;
 
     commandBuffer.reset();
 
-    recordDrawCommands(commandBuffer, imageIndex);
-
-    SubmitInfo submitInfo;
-
-    Semaphore waitSemaphores[] = {currentFrame.imageAvailable};
-    PipelineStageFlags waitStages[] = {PipelineStageFlagBits::eColorAttachmentOutput};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
-
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    Semaphore signalSemaphores[] = {currentFrame.renderFinished};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-
-    logicalDevice.resetFences(1, &currentFrame.inFlight);
-    try {
-        graphicsQueue.submit(submitInfo, currentFrame.inFlight);
-    } catch (const SystemError &err) {
-        if (m_globalSettings.debugMode) {
-            LOG_ERROR("Failed to submit draw command buffer!\n{}", err.what());
+    frameStats = FrameStats();
+    frameStats.pipelines = static_cast<uint32_t>(pipelineLibrary.getPipelineCount());
+    frameStats.stalls = stallDetector.getStats();
+    frameStats.inputLatency = latencyTracker.getStats();
+    submitBatcher.resetStats();
+    // The sorted queue stays valid as long as the draws don't change
+    if (drawCommandsDirty) {
+        buildRenderQueue();
+        staticCommands.invalidate();
+        drawCommandsDirty = false;
+    }
+    // Late latch: the camera follows the cursor events that arrived after the packet was filled
+    double inputTime = packet.inputTime;
+    glm::mat4 viewProjection = packet.viewProjection;
+    if (m_globalSettings.lateLatch && packet.latchViewProjection) {
+        CursorLatch latch = Events::latchCursor();
+        viewProjection = packet.latchViewProjection(latch.position);
+        gpuScene.setViewProjection(viewProjection);
+        if (inputTime == 0.0) {
+            inputTime = latch.inputTime;
         }
     }
+    // The image's last frame completed above, so its camera is free to write. Replayed recordings read it too.
+    cameraBuffers.write(imageIndex, viewProjection);
+    buildRenderGraph(imageIndex, currentFrame);
+    recordDrawCommands(commandBuffer);
+    frameStats.gpuZones = gpuProfiler.getZones();
+    frameStats.gpuFrameMilliseconds = gpuProfiler.getFrameMilliseconds();
+    frameStats.passStatistics = pipelineStatistics.getPasses();
+
+    uploadQueue.submit(submitBatcher, graphicsQueue, submittedFrames + 1);
+    // Compute results are consumed by indirect draws and vertex shaders
+    asyncCompute.submit(submitBatcher, PipelineStageFlagBits2::eDrawIndirect | PipelineStageFlagBits2::eVertexShader);
+    submitBatcher.wait(graphicsQueue, currentFrame.imageAvailable, PipelineStageFlagBits2::eColorAttachmentOutput);
+    submitBatcher.submit(graphicsQueue, commandBuffer);
+
+    uint64_t frameValue = submittedFrames + 1;
+    submitBatcher.signal(graphicsQueue, image.renderFinished);
+    // The timeline is signaled with the frame number
+    if (capabilities.timelineSemaphore) {
+        submitBatcher.signal(graphicsQueue, graphicsTimeline.semaphore, frameValue);
+    } else {
+        logicalDevice.resetFences(1, &currentFrame.inFlight);
+    }
+
+    submitBatcher.flush(graphicsQueue, currentFrame.inFlight);
+    submitBatcher.flushAll();
+    frameStats.submits = submitBatcher.getSubmitCount();
+    frameStats.submitBatches = submitBatcher.getBatchCount();
+    submittedFrames = frameValue;
+    graphicsTimeline.submittedValue = frameValue;
+    latencyTracker.submit(frameValue, inputTime);
+    currentFrame.submittedFrame = frameValue;
+    image.renderingFrame = frameValue;
 
     PresentInfoKHR presentInfo;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &image.renderFinished;
 
     SwapchainKHR swapChains[] = {swapchain};
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapChains;
     presentInfo.pImageIndices = &imageIndex;
 
+    SwapchainPresentFenceInfoEXT presentFenceInfo;
+    if (capabilities.swapchainMaintenance1) {
+        logicalDevice.resetFences(1, &currentFrame.presentFence);
+        presentFenceInfo.swapchainCount = 1;
+        presentFenceInfo.pFences = &currentFrame.presentFence;
+        presentFenceInfo.pNext = presentInfo.pNext;
+        presentInfo.pNext = &presentFenceInfo;
+    }
+    PresentIdKHR presentIdInfo;
+    if (capabilities.presentWait) {
+        presentIdInfo.swapchainCount = 1;
+        presentIdInfo.pPresentIds = &frameValue;
+        presentIdInfo.pNext = presentInfo.pNext;
+        presentInfo.pNext = &presentIdInfo;
+    }
+
     Result present;
     try {
+        StallDetector::Scope stall(stallDetector, StallDetector::Point::Present);
         present = presentQueue.presentKHR(presentInfo);
     } catch (const OutOfDateKHRError &error) {
         present = Result::eErrorOutOfDateKHR;
     }
-    if (present == Result::eErrorOutOfDateKHR || present == Result::eSuboptimalKHR) {
-        LOG_INFO("Recreate Swapchain");
-        recreateSwapchain();
-        return;
-    }
 
     frameNumber = (frameNumber + 1) % maxFramesInFlight;
+
+    // Recreated at the start of the next frame, the pipeline does not depend on the extent
+    if (present == Result::eErrorOutOfDateKHR || present == Result::eSuboptimalKHR) {
+        swapchainOutdated = true;
+    }
 }
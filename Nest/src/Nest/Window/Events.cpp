@@ -11,30 +11,61 @@ bool Events::mouseButtons[];
 uint32_t Events::framesKeys[];
 uint32_t Events::framesMouseButtons[];
 uint32_t Events::frame = 0;
+uint32_t Events::eventFrame = 0;
+std::thread::id Events::mainThread;
+int Events::framebufferWidth = 0;
+int Events::framebufferHeight = 0;
+uint32_t Events::framesFramebufferResized = 0;
 bool Events::cursorLocked = false;
 void* Events::m_handle = nullptr;
+std::mutex Events::inputMutex;
+glm::vec2 Events::cursorPosition = glm::vec2(0.0f);
+double Events::pendingInputTime = 0.0;
+
+void Events::markInput() {
+    std::lock_guard lock(inputMutex);
+    if (pendingInputTime == 0.0) {
+        pendingInputTime = glfwGetTime();
+    }
+}
 
 void Events::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    markInput();
     if (action == GLFW_PRESS) {
         keys[key] = true;
-        framesKeys[key] = frame;
+        framesKeys[key] = eventFrame;
     } else if (action == GLFW_RELEASE){
         keys[key] = false;
-        framesKeys[key] = frame;
+        framesKeys[key] = eventFrame;
     }
 }
 void Events::mouseCallback(GLFWwindow* window, int button, int action, int mode) {
+    markInput();
     if (action == GLFW_PRESS){
         keys[button] = true;
-        framesMouseButtons[button] = frame;
+        framesMouseButtons[button] = eventFrame;
     } else if (action == GLFW_RELEASE){
         keys[button] = false;
-        framesMouseButtons[button] = frame;
+        framesMouseButtons[button] = eventFrame;
     }
 }
 
+void Events::cursorPosCallback(GLFWwindow* window, double x, double y) {
+    markInput();
+    std::lock_guard lock(inputMutex);
+    cursorPosition = {x, y};
+}
+
+void Events::framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+    framebufferWidth = width;
+    framebufferHeight = height;
+    framesFramebufferResized = eventFrame;
+}
+
 void Events::init(void* handle) {
     frame = 0;
+    eventFrame = 0;
+    mainThread = std::this_thread::get_id();
     cursorLocked = false;
     m_handle = handle;
 
@@ -45,6 +76,12 @@ void Events::init(void* handle) {
 
     glfwSetKeyCallback((GLFWwindow *) m_handle, keyCallback);
     glfwSetMouseButtonCallback((GLFWwindow *) m_handle, mouseCallback);
+    glfwSetCursorPosCallback((GLFWwindow *) m_handle, cursorPosCallback);
+    cursorPosition = getCursorPos();
+    pendingInputTime = 0.0;
+    glfwGetFramebufferSize((GLFWwindow *) m_handle, &framebufferWidth, &framebufferHeight);
+    framesFramebufferResized = 0;
+    glfwSetFramebufferSizeCallback((GLFWwindow *) m_handle, framebufferSizeCallback);
 }
 
 glm::vec2 Events::getCursorPos() {
@@ -85,11 +122,43 @@ bool Events::isJustMouseButtonPressed(MouseButton mouseButton) {
     return keys[int(mouseButton)] && framesMouseButtons[int(mouseButton)] == frame;
 }
 
+bool Events::isJustFramebufferResized() {
+    return frame != 0 && framesFramebufferResized == frame;
+}
+
+glm::ivec2 Events::getFramebufferSize() {
+    return { framebufferWidth, framebufferHeight };
+}
+
 void Events::pollEvents() {
     frame++;
+    eventFrame = frame;
     glfwPollEvents();
 }
 
+void Events::waitEvents() {
+    glfwWaitEvents();
+}
+
+double Events::consumeInputTime() {
+    std::lock_guard lock(inputMutex);
+    double inputTime = pendingInputTime;
+    pendingInputTime = 0.0;
+    return inputTime;
+}
+
+CursorLatch Events::latchCursor() {
+    // GLFW only polls on the main thread, a render thread sees the events polled for later frames instead
+    if (std::this_thread::get_id() == mainThread) {
+        eventFrame = frame + 1;
+        glfwPollEvents();
+    }
+    std::lock_guard lock(inputMutex);
+    CursorLatch latch = {cursorPosition, pendingInputTime};
+    pendingInputTime = 0.0;
+    return latch;
+}
+
 void Events::toggleCursorLock() {
     cursorLocked = !cursorLocked;
     glm::vec2 cursorPos = getCursorPos();
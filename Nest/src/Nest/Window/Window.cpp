@@ -26,14 +26,10 @@ void Window::init(const char *name, int resolutionX, int resolutionY, bool fullS
     // set min size
     glfwSetWindowSizeLimits(window, 640,480, GLFW_DONT_CARE, GLFW_DONT_CARE);
 
-//    glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
-
     if (!window) {
         LOG_CRITICAL("GLFW window creation failed");
         glfwTerminate();
     }
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
     this->handle = window;
     Events::init(handle);
 }
@@ -58,10 +54,6 @@ double Window::getTime() {
     return glfwGetTime();
 }
 
-void Window::swapBuffers() {
-    glfwSwapBuffers((GLFWwindow*) handle);
-}
-
 void Window::setShouldClose() {
     glfwSetWindowShouldClose((GLFWwindow*) handle, true);
 }
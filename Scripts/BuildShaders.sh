@@ -1,2 +1,4 @@
 glslc Nest/res/Shaders/vst.vert -o Nest/res/Shaders/CompileShaders/vst.spv
-glslc Nest/res/Shaders/fst.frag -o Nest/res/Shaders/CompileShaders/fst.spv
\ No newline at end of file
+glslc Nest/res/Shaders/fst.frag -o Nest/res/Shaders/CompileShaders/fst.spv
+glslc Nest/res/Shaders/gpuDriven.vert -o Nest/res/Shaders/CompileShaders/gpuDriven.spv
+glslc Nest/res/Shaders/cull.comp -o Nest/res/Shaders/CompileShaders/cull.spv
\ No newline at end of file